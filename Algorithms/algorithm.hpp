@@ -1,9 +1,21 @@
 #pragma once
 #include <vector>
 #include <chrono>
+#include <atomic>
 
 #include "../Functions/function.hpp"
-#include "../individual.hpp"
+#include "../population.hpp"
+#include "../batch_decode.hpp"
+#include "../mutation.hpp"
+#include "../fingerprint.hpp"
+#include "../parallel.hpp"
+#include "../random.hpp"
+#include "../fitness_cache.hpp"
+#include "../allocation_counter.hpp"
+#include "../evaluation_executor.hpp"
+#include "../stopping.hpp"
+#include <memory>
+#include <functional>
 
 struct GenerationPerformance
 {
@@ -16,6 +28,8 @@ struct GenerationPerformance
     double worst_objective_function_value;
     std::vector<double> best_solution;
     std::vector<double> worst_solution;
+    // The number of distinct genomes in the population.
+    size_t distinct_individuals = 0;
 
     GenerationPerformance() = default;
 
@@ -43,6 +57,19 @@ struct GenerationPerformance
     }
 };
 
+/**
+ * The best, worst and totals of an evaluated population.
+ * best and worst are the first members with the highest and lowest fitness,
+ * as std::max_element and std::min_element would find them.
+ */
+struct PopulationSummary
+{
+    size_t best = 0;
+    size_t worst = 0;
+    double fitness_sum = 0.0;
+    double objective_sum = 0.0;
+};
+
 class Algorithm
 {
 protected:
@@ -53,8 +80,367 @@ protected:
     size_t variable_size;
     size_t number_of_variables;
     OptimizationFunction &function;
+    GeometricMutation mutation;
+    PopulationFingerprint fingerprint;
+    BatchDecoder decoder;
+    // One decoded matrix and list of members to evaluate per thread, see evaluate().
+    std::vector<DecodedPopulation> decoded;
+    std::vector<std::vector<size_t>> misses;
+    std::vector<size_t> pending;
+    std::vector<double> objective_values;
+    // Optional, shared between runs on the same objective, see set_cache().
+    std::shared_ptr<FitnessCache> cache;
+    // Re-evaluate separable objectives term by term, see set_delta_evaluation().
+    bool delta_evaluation = false;
+    std::vector<PopulationSummary> partial_summaries;
+    // The number of threads one run may use, see set_threads().
+    size_t threads = 1;
+    // The experiment seed and the index of this run, see set_seed().
+    uint64_t seed = rng::random_seed();
+    uint64_t run_index = 0;
+    // The number of evaluate() calls so far in this run; numbers their streams.
+    uint64_t evaluation_batches = 0;
+    // Objective evaluations of the current run, cache hits and skipped members excluded.
+    uint64_t evaluation_count = 0;
+    // Ends runs early, see set_stopping_criteria().
+    StoppingRule stopping;
+    // Heap allocations of the last run after its first generation, see get_steady_state_allocations().
+    uint64_t steady_state_allocations = 0;
+    // Optional, evaluates blocks on worker threads, see set_executor().
+    std::shared_ptr<EvaluationExecutor> executor;
+    // Blocks handed to the executor by submit_evaluation() and not collected
+    // yet; the members of a block are submitted_members[first, first + count).
+    struct Submission
+    {
+        size_t ticket;
+        size_t first;
+        size_t count;
+    };
+    std::vector<Submission> submissions;
+    std::vector<size_t> submitted_members;
+    bool submitting = false;
+    uint64_t submitted_batch = 0;
+    size_t submitted_until = 0;
+    // The block being filled: members that need a value, its first one, and where its misses start.
+    size_t open_block_size = 0;
+    size_t open_block_member = 0;
+    size_t open_block_first = 0;
+    // Called between generations, see set_generation_hook().
+    std::function<bool(const GenerationPerformance &, Population &)> generation_hook;
+
+    /**
+     * @brief Reset the per-run state. Called first by every run().
+     */
+    void start_run()
+    {
+        this->evaluation_batches = 0;
+        this->steady_state_allocations = 0;
+        this->evaluation_count = 0;
+        this->stopping.start();
+    }
+
+    /**
+     * @brief Check whether the run ends with a generation just recorded, see set_stopping_criteria().
+     */
+    bool should_stop(const GenerationPerformance &record)
+    {
+        return this->stopping.should_stop(record.best_objective_function_value, record.distinct_individuals, this->evaluation_count,
+                                          this->stopping.elapsed(), function.getMinY(), function.isDeterministic());
+    }
+
+    /**
+     * @brief Get the random stream of one unit of work of this run.
+     * @param phase What the stream is used for.
+     * @param generation The generation.
+     * @param slot The individual or pair within the generation.
+     */
+    rng::Stream stream(rng::Phase phase, uint64_t generation, uint64_t slot) const
+    {
+        return rng::Stream(this->seed, phase, this->run_index, generation, slot);
+    }
+
+    /**
+     * @brief Seat the calling thread's generator on the stream of one unit of work.
+     * Everything drawn through get_generator() until the next seat comes from it.
+     */
+    void seat(rng::Phase phase, uint64_t generation, uint64_t slot) const
+    {
+        get_generator() = stream(phase, generation, slot);
+    }
+
+    /**
+     * @brief Allocate a population's per-variable terms if delta evaluation applies.
+     * Engines call it on the populations they breed into before breeding
+     * in parallel, so copies carry the terms from the first generation on.
+     */
+    void prepare_terms(Population &population) const
+    {
+        if (this->delta_evaluation && this->function.isSeparable())
+        {
+            population.enable_terms();
+        }
+    }
+
+    /**
+     * @brief Evaluate the members of a population whose genome changed.
+     * For deterministic objectives members that still hold a value are
+     * skipped and the rest are looked up in the cache, if one is set; noisy
+     * objectives evaluate every member. The remaining members are split into
+     * blocks. With delta evaluation, separable objectives update each
+     * member's per-variable terms (Population::evaluate_terms); otherwise each block is decoded into its
+     * thread's reused matrix and handed to the objective's batch evaluation
+     * in one call, with the generator seated on the block's first member.
+     * With an executor the blocks go to its workers instead, after any
+     * already handed over with submit_evaluation().
+     * @param population The population to evaluate.
+     */
+    void evaluate(Population &population)
+    {
+        if (pipelined())
+        {
+            submit_evaluation(population, this->submitting ? this->submitted_until : 0, population.size());
+            collect_evaluation(population);
+            return;
+        }
+        auto deterministic = function.isDeterministic();
+        pending.clear();
+        for (size_t i = 0; i < population.size(); i++)
+        {
+            if (!deterministic || !population.is_evaluated(i))
+            {
+                pending.push_back(i);
+            }
+        }
+        objective_values.resize(population.size());
+        decoded.resize(threads);
+        misses.resize(threads);
+        auto batch = this->evaluation_batches++;
+        auto cached = deterministic ? this->cache.get() : nullptr;
+        auto separable = this->delta_evaluation && function.isSeparable();
+        if (separable)
+        {
+            // Allocated before the blocks run, since they evaluate terms concurrently.
+            population.enable_terms();
+        }
+        std::atomic<uint64_t> evaluated = 0;
+        parallel::for_each_block(pending.size(), block_size, threads, [&](size_t begin, size_t end, size_t chunk)
+                                 {
+            seat(rng::Phase::evaluation, batch, pending[begin]);
+            auto &members = misses[chunk];
+            members.clear();
+            for (size_t k = begin; k < end; k++)
+            {
+                auto value = cached ? cached->find(population.genome(pending[k])) : std::nullopt;
+                if (value)
+                {
+                    population.set_result(pending[k], *value);
+                }
+                else
+                {
+                    members.push_back(pending[k]);
+                }
+            }
+            if (members.empty())
+            {
+                return;
+            }
+            evaluated.fetch_add(members.size(), std::memory_order_relaxed);
+            if (separable)
+            {
+                // Only the terms of changed variables are recomputed; noise comes from each member's own stream.
+                for (auto i : members)
+                {
+                    if (!deterministic)
+                    {
+                        seat(rng::Phase::evaluation, batch, i);
+                    }
+                    population.evaluate_terms(i);
+                    if (cached)
+                    {
+                        cached->insert(population.genome(i), population.objective(i));
+                    }
+                }
+                return;
+            }
+            auto values = std::span(objective_values).subspan(begin, members.size());
+            decoder.decode(members, decoded[chunk], [&](size_t i)
+                           { return population.genome(i); });
+            function.evalBatch(decoded[chunk], values);
+            for (size_t j = 0; j < members.size(); j++)
+            {
+                population.set_result(members[j], values[j]);
+                if (cached)
+                {
+                    cached->insert(population.genome(members[j]), values[j]);
+                }
+            }
+        });
+        this->evaluation_count += evaluated.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Check whether evaluations go through the executor.
+     * Delta evaluation stays on the calling thread, as it needs each member's terms.
+     */
+    bool pipelined() const
+    {
+        return this->executor && !(this->delta_evaluation && function.isSeparable());
+    }
+
+    /**
+     * @brief Start evaluating the members [begin, end) of a population on the executor.
+     * Members are submitted in order and grouped into the same blocks as
+     * evaluate() would form (block_size members that need a value, cache
+     * hits included), each drawing from the stream evaluate() would seat
+     * for it; a block is handed over as soon as it is full. The next
+     * evaluate() of the population hands over the rest and collects them.
+     * Members must not change until then.
+     * @param population The population; the one later passed to evaluate(), possibly after a swap.
+     * @param begin The first member; where the previous submission of this evaluation ended.
+     * @param end One past the last member.
+     */
+    void submit_evaluation(Population &population, size_t begin, size_t end)
+    {
+        assert(this->executor);
+        if (!this->submitting)
+        {
+            this->submitting = true;
+            this->submitted_batch = this->evaluation_batches++;
+            this->submitted_until = 0;
+            this->open_block_size = 0;
+        }
+        assert(begin == this->submitted_until && end <= population.size());
+        this->submitted_until = end;
+        auto deterministic = function.isDeterministic();
+        auto cached = deterministic ? this->cache.get() : nullptr;
+        for (auto i = begin; i < end; i++)
+        {
+            if (deterministic && population.is_evaluated(i))
+            {
+                continue;
+            }
+            if (this->open_block_size == 0)
+            {
+                this->open_block_member = i;
+                this->open_block_first = this->submitted_members.size();
+            }
+            auto value = cached ? cached->find(population.genome(i)) : std::nullopt;
+            if (value)
+            {
+                population.set_result(i, *value);
+            }
+            else
+            {
+                this->submitted_members.push_back(i);
+            }
+            if (++this->open_block_size == block_size)
+            {
+                submit_block(population);
+            }
+        }
+    }
+
+    /**
+     * @brief Hand the open block of submit_evaluation() to the executor.
+     */
+    void submit_block(const Population &population)
+    {
+        auto first = this->open_block_first;
+        auto count = this->submitted_members.size() - first;
+        this->open_block_size = 0;
+        if (count == 0)
+        {
+            return;
+        }
+        auto ticket = this->executor->acquire();
+        decoder.decode(std::span(this->submitted_members).subspan(first, count), this->executor->input(ticket), [&](size_t i)
+                       { return population.genome(i); });
+        this->executor->submit(ticket, function, stream(rng::Phase::evaluation, this->submitted_batch, this->open_block_member));
+        this->submissions.push_back({ticket, first, count});
+    }
+
+    /**
+     * @brief Wait for the submitted blocks and store their results.
+     */
+    void collect_evaluation(Population &population)
+    {
+        if (this->open_block_size > 0)
+        {
+            submit_block(population);
+        }
+        auto cached = function.isDeterministic() ? this->cache.get() : nullptr;
+        for (const auto &submission : this->submissions)
+        {
+            auto values = this->executor->collect(submission.ticket);
+            this->evaluation_count += submission.count;
+            for (size_t j = 0; j < submission.count; j++)
+            {
+                auto i = this->submitted_members[submission.first + j];
+                population.set_result(i, values[j]);
+                if (cached)
+                {
+                    cached->insert(population.genome(i), values[j]);
+                }
+            }
+            this->executor->release(submission.ticket);
+        }
+        this->submissions.clear();
+        this->submitted_members.clear();
+        this->submitting = false;
+    }
+
+    /**
+     * @brief Hand a generation's record and the population the next generation is bred from to the generation hook, if any.
+     * @return Whether the run goes on.
+     */
+    bool end_generation(const GenerationPerformance &record, Population &population)
+    {
+        return !this->generation_hook || this->generation_hook(record, population);
+    }
+
+    /**
+     * @brief Find the best and worst members and the fitness and objective totals.
+     * Each block is summarized on its own and the blocks are merged in order,
+     * so the totals do not depend on the thread count.
+     * @param size The number of members.
+     * @param fitness_of Maps an index to the member's fitness.
+     * @param objective_of Maps an index to the member's objective function value.
+     */
+    template <typename FitnessOf, typename ObjectiveOf>
+    PopulationSummary summarize(size_t size, FitnessOf fitness_of, ObjectiveOf objective_of)
+    {
+        assert(size > 0);
+        auto blocks = (size + block_size - 1) / block_size;
+        partial_summaries.resize(blocks);
+        parallel::for_each_block(size, block_size, threads, [&](size_t begin, size_t end, size_t)
+                                 {
+            PopulationSummary summary{begin, begin, 0.0, 0.0};
+            for (size_t i = begin; i < end; i++)
+            {
+                auto fitness = fitness_of(i);
+                summary.best = fitness > fitness_of(summary.best) ? i : summary.best;
+                summary.worst = fitness < fitness_of(summary.worst) ? i : summary.worst;
+                summary.fitness_sum += fitness;
+                summary.objective_sum += objective_of(i);
+            }
+            partial_summaries[begin / block_size] = summary;
+        });
+        auto summary = partial_summaries[0];
+        for (size_t block = 1; block < blocks; block++)
+        {
+            const auto &partial = partial_summaries[block];
+            summary.best = fitness_of(partial.best) > fitness_of(summary.best) ? partial.best : summary.best;
+            summary.worst = fitness_of(partial.worst) < fitness_of(summary.worst) ? partial.worst : summary.worst;
+            summary.fitness_sum += partial.fitness_sum;
+            summary.objective_sum += partial.objective_sum;
+        }
+        return summary;
+    }
 
 public:
+    // Evaluation and statistics are split into blocks of this many members.
+    static constexpr size_t block_size = 64;
+
     Algorithm(
         size_t pop_size,
         size_t num_of_gens,
@@ -68,6 +454,119 @@ public:
                                       mutation_prob(mutation_p),
                                       variable_size(variable_size),
                                       number_of_variables(num_of_variables),
-                                      function(func) {}
+                                      function(func),
+                                      mutation(mutation_p),
+                                      decoder(variable_size, num_of_variables, func.getXRange().first, func.getXRange().second) {}
+    virtual ~Algorithm() = default;
     virtual std::vector<GenerationPerformance> run() = 0;
+
+    /**
+     * @brief Set the number of threads run() may use for one generation.
+     * Evaluation, breeding and statistics are split across this many
+     * threads; the default of 1 runs everything on the calling thread.
+     * When several runs execute in parallel, use parallel::threads_per_job.
+     */
+    void set_threads(size_t run_threads)
+    {
+        assert(run_threads > 0);
+        this->threads = run_threads;
+    }
+
+    /**
+     * @brief Make run() reproducible.
+     * Every random draw of the run comes from a stream keyed by the seed,
+     * the run index, the generation and the individual, so the same seed
+     * and run index give the same result for any thread count. Without a
+     * call the seed is random.
+     * @param experiment_seed The seed shared by all runs of an experiment.
+     * @param run The index of this run within the experiment.
+     */
+    void set_seed(uint64_t experiment_seed, uint64_t run)
+    {
+        this->seed = experiment_seed;
+        this->run_index = run;
+    }
+
+    /**
+     * @brief Reuse objective function values through a genome cache.
+     * The cache may be shared by runs on the same objective and genome
+     * geometry. It is only consulted for deterministic objectives.
+     * @param fitness_cache The cache, or nullptr to evaluate every changed genome.
+     */
+    void set_cache(std::shared_ptr<FitnessCache> fitness_cache)
+    {
+        this->cache = std::move(fitness_cache);
+    }
+
+    /**
+     * @brief Re-evaluate separable objectives by recomputing only changed terms.
+     * Every member then keeps its per-variable terms, which makes copies
+     * more expensive; it pays off when a term costs much more than that,
+     * not for the De Jong functions, whose batch kernels are faster.
+     * Has no effect for objectives that are not separable.
+     */
+    void set_delta_evaluation(bool enabled)
+    {
+        this->delta_evaluation = enabled;
+    }
+
+    /**
+     * @brief Evaluate on the worker threads of an executor.
+     * SimpleGA and CHC then hand each block of children to the executor as
+     * soon as it is bred, so evaluating it overlaps breeding the next; they
+     * breed on the calling thread only. Results are the same as without one.
+     * The executor may be shared between runs. The specialized engines of
+     * make_simple_ga and make_chc evaluate on the run's threads and ignore
+     * it; they are only made for the De Jong functions themselves, so a
+     * wrapped objective such as SlowFunction always gets an engine that uses it.
+     * @param evaluation_executor The executor, or nullptr to evaluate on the run's threads.
+     */
+    void set_executor(std::shared_ptr<EvaluationExecutor> evaluation_executor)
+    {
+        this->executor = std::move(evaluation_executor);
+    }
+
+    /**
+     * @brief End runs as soon as a generation meets any of the criteria.
+     * The series returned by run() then ends with that generation instead
+     * of having num_of_generations records. Without a call every run
+     * goes to its last generation.
+     */
+    void set_stopping_criteria(const StoppingCriteria &criteria)
+    {
+        this->stopping = StoppingRule(criteria);
+    }
+
+    /**
+     * @brief Get the number of objective evaluations of the last run, cache hits excluded.
+     */
+    uint64_t get_evaluations() const
+    {
+        return this->evaluation_count;
+    }
+
+    /**
+     * @brief Let a caller see and change the population between generations.
+     * SimpleGA and CHC call the hook once per generation, after its record
+     * is written, with the population the next generation is bred from.
+     * The hook may overwrite members (Population::copy), e.g. with migrants
+     * of an island model; it runs on the thread calling run(). If it
+     * returns false the run ends, its series ending with that generation.
+     * @param hook Called with the generation's record and the population, or empty for none.
+     */
+    void set_generation_hook(std::function<bool(const GenerationPerformance &, Population &)> hook)
+    {
+        this->generation_hook = std::move(hook);
+    }
+
+    /**
+     * @brief Get the number of heap allocations the last run made after its first generation.
+     * Once the first generation has grown every buffer, the generational
+     * loop of SimpleGA allocates nothing. Only counted in builds with
+     * GA_COUNT_ALLOCATIONS, and only on the thread calling run(); 0 otherwise.
+     */
+    uint64_t get_steady_state_allocations() const
+    {
+        return this->steady_state_allocations;
+    }
 };
\ No newline at end of file
@@ -1,257 +1,200 @@
 #include "chc.hpp"
 
-std::vector<Individual> CHC::generate_initial_population()
+Population CHC::generate_initial_population()
 {
-    std::vector<Individual> population;
-    population.reserve(population_size);
+    Population population(GenomeSchema(variable_size, number_of_variables, function), population_size);
     for (size_t i = 0; i < population_size; i++) {
-        auto individual = Individual(variable_size, number_of_variables, function);
-        population.emplace_back(std::move(individual));
+        seat(rng::Phase::initialization, 0, i);
+        population.randomize(i);
     }
-    // Randomization is done in the constructor
+    prepare_terms(population);
     return population;
 }
 
-std::vector<Individual> CHC::select_parents(const std::vector<Individual> &population)
+void CHC::select_parents(const Population &population, Population &parents)
 {
-    std::vector parents = population;
-    std::shuffle(parents.begin(), parents.end(), get_generator()); 
-    return parents;
+    order.resize(population.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), get_generator());
+    if (parents.size() != population.size())
+    {
+        parents = population;
+    }
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        parents.copy(i, population, order[i]);
+    }
 }
 
-size_t CHC::hamming_distance(const Individual &individual1, const Individual &individual2)
+size_t CHC::hamming_distance(const Population &population, size_t first, size_t second)
 {
-    const auto &vector1 = individual1.getVector();
-    const auto &vector2 = individual2.getVector();
-    assert(vector1.size() == vector2.size());
-    // Magical one-liner to calculate hamming distance
-    // Iterate through the two vectors and add 1 to the sum if the bits are different
-    // Takes the following parameters:
-    // 1. The beginning iterator of vector1
-    // 2. The ending iterator of vector1
-    // 3. The beginning iterator of vector2 (since both vectors are the same size,
-    // the ending iterator is at the same point as same as vector1)
-    // 4. The initial value of the sum
-    // 5. The function to apply to difference vector
-    // 6. The function to apply to the pairs of bits
-    return (size_t)std::transform_reduce(
-        vector1.begin(),
-        vector1.end(),
-        vector2.begin(),
-        0,
-        std::plus<size_t>(),       // Summation
-        [](bool bit1, bool bit2) { // Bit difference
-            return bit1 != bit2;
-        });
+    // XOR the packed words and count the set bits.
+    return population.genome(first).hamming_distance(population.genome(second));
 }
 
-std::vector<size_t> CHC::get_different_indices(
-    const bitstring &vector1,
-    const bitstring &vector2)
+void CHC::crossover(
+    const Population &recomb_parents,
+    double difference_threshold,
+    Population &children,
+    size_t generation)
 {
-    assert(vector1.size() == vector2.size());
-    std::vector<size_t> different_indices;
-    for (size_t i = 0; i < vector1.size(); i++)
+    // Copying into the existing children reuses their arena.
+    if (children.size() != recomb_parents.size())
     {
-        if (vector1[i] != vector2[i])
-        {
-            different_indices.push_back(i);
-        }
+        children = recomb_parents;
     }
-    return different_indices;
-}
-
-std::vector<Individual> CHC::crossover(
-    const std::vector<Individual> &recomb_parents,
-    double difference_threshold)
-{
-    std::vector<Individual> children;
-    for (size_t i = 0; i < recomb_parents.size() - 1; i += 2)
+    auto size = recomb_parents.size();
+    auto cross = [&](size_t begin, size_t end, size_t chunk)
     {
-        auto hamming_dist = hamming_distance(recomb_parents[i], recomb_parents[i + 1]);
-        if (((double)hamming_dist) / 2.0 > difference_threshold)
+        for (size_t i = 2 * begin; i < std::min(2 * end, size); i += 2)
         {
-            auto different_indices = get_different_indices(
-                recomb_parents[i].getVector(),
-                recomb_parents[i + 1].getVector());
-            auto child1 = recomb_parents[i];
-            auto child2 = recomb_parents[i + 1];
-            //Select half of the different indices to be flipped randomly
-            std::shuffle(different_indices.begin(), different_indices.end(), get_generator());
-            for (auto index : std::ranges::take_view{different_indices, (int) different_indices.size() / 2})
+            seat(rng::Phase::breeding, generation, i / 2);
+            children.copy(i, recomb_parents, i);
+            if (i + 1 == size)
+            {
+                break;
+            }
+            children.copy(i + 1, recomb_parents, i + 1);
+            auto hamming_dist = hamming_distance(recomb_parents, i, i + 1);
+            if (((double)hamming_dist) / 2.0 > difference_threshold)
             {
-                child1.setValueAt(index, recomb_parents[i + 1].getVector()[index]);
-                child2.setValueAt(index, recomb_parents[i].getVector()[index]);
+                // Exchange a random half of the differing bits.
+                auto child1 = children.mutable_genome(i);
+                auto child2 = children.mutable_genome(i + 1);
+                hux[chunk].apply(child1, child2);
             }
-            children.push_back(child1);
-            children.push_back(child2);
         }
-        else
+    };
+    auto pairs = (size + 1) / 2;
+    if (pipelined())
+    {
+        // Hand each block of children to the executor as soon as it is
+        // crossed; run() then collects them with evaluate().
+        for (size_t begin = 0; begin < pairs; begin += block_size / 2)
         {
-            children.push_back(recomb_parents[i]);
-            children.push_back(recomb_parents[i + 1]);
+            auto end = std::min(pairs, begin + block_size / 2);
+            cross(begin, end, 0);
+            submit_evaluation(children, 2 * begin, std::min(2 * end, size));
         }
     }
-    return children;
+    else
+    {
+        parallel::for_each_chunk(pairs, threads, cross);
+    }
 }
 
-void CHC::mutate(std::vector<Individual> &children)
+void CHC::mutate(Population &children)
 {
-    for (auto &individual : children)
+    for (size_t i = 0; i < children.size(); i++)
     {
-        std::uniform_real_distribution<double> distribution(0.0, 1.0);
-        for (size_t i = 0; i < variable_size * number_of_variables; i++)
-        {
-            if (distribution(get_generator()) < mutation_prob)
-            {
-                individual.flip(i);
-            }
-        }
+        children.mutate(i, mutation);
     }
 }
 
-std::vector<Individual> CHC::select_survivors(
-    std::vector<Individual> &parents,
-    std::vector<Individual> &children)
+void CHC::select_survivors(
+    const Population &parents,
+    const Population &children,
+    Population &survivors)
 {
     // Check if the parents and children have been evaluated.
     for (size_t i = 0; i < population_size; i++)
     {
-        assert(parents[i].isEvaluated());
-        assert(children[i].isEvaluated());
+        assert(parents.is_evaluated(i));
+        assert(children.is_evaluated(i));
     }
-    auto sorted_parents(parents);
-    //std::sort(sorted_parents.begin(), sorted_parents.end());
-    //Manually sort the parents
-    for (size_t i = 0; i < sorted_parents.size(); i++)
+    auto fitness_of = [&](size_t index)
     {
-        for (size_t j = i + 1; j < sorted_parents.size(); j++)
-        {
-            if (sorted_parents[i] < sorted_parents[j])
-            {
-                std::swap(sorted_parents[i], sorted_parents[j]);
-            }
-        }
-    }
-    auto sorted_children(children);
-    //std::sort(sorted_children.begin(), sorted_children.end());
-    //Manually sort the children
-    for (size_t i = 0; i < sorted_children.size(); i++)
+        return index < parents.size() ? parents.fitness(index) : children.fitness(index - parents.size());
+    };
+    auto winners = elitist_selection.select(parents.size(), children.size(), population_size, fitness_of);
+    if (survivors.size() != population_size)
     {
-        for (size_t j = i + 1; j < sorted_children.size(); j++)
-        {
-            if (sorted_children[i] < sorted_children[j])
-            {
-                std::swap(sorted_children[i], sorted_children[j]);
-            }
-        }
+        survivors.resize(population_size);
     }
-    std::vector<Individual> survivors(parents);
-
-    auto parent_it = sorted_parents.begin();
-    auto child_it = sorted_children.begin();
-    for (size_t i = 0; i < survivors.size(); i++)
+    for (size_t i = 0; i < population_size; i++)
     {
-        if (*child_it < *parent_it)
+        auto index = winners[i].index;
+        if (index < parents.size())
         {
-            survivors[i] = *parent_it;
-            parent_it++;
+            survivors.copy(i, parents, index);
         }
         else
         {
-            survivors[i] = *child_it;
-            child_it++;
+            survivors.copy(i, children, index - parents.size());
         }
     }
-    return survivors;
 }
 
-std::vector<Individual> CHC::diverge_if_converged(const std::vector<Individual> &population)
+void CHC::diverge_if_converged(Population &population, size_t generation)
 {
-    auto best_individual = *std::max_element(
-        population.begin(),
-        population.end());
-    std::vector<Individual> new_population(
-        population_size,
-        best_individual);
-    // Mutate all but the first of the copies.
-    // Mutation is bit-flip mutation of (mutation_prob * size of bitstring) random bits
-    for (auto &individual : std::ranges::drop_view{new_population, 1})
-    {
-        auto number_of_bit_flips = (size_t)std::round(mutation_prob * (double)individual.getVector().size());
-        // Magical way to generate a random permutation of indices
-        std::vector<size_t> indices(individual.getVector().size());
-        std::iota(indices.begin(), indices.end(), 0);
-        std::shuffle(indices.begin(), indices.end(), get_generator());
-
-        for (auto index : indices | std::views::take(number_of_bit_flips))
-        {
-            individual.flip(index);
-        }
-    }
-    for (auto &individual : new_population)
+    // The first member with the highest fitness, as std::max_element finds it.
+    size_t best = 0;
+    for (size_t i = 1; i < population.size(); i++)
     {
-        individual.evaluate();
+        best = population.fitness(i) > population.fitness(best) ? i : best;
     }
-    return new_population;
+    // Keep one copy of the best member in the first slot and fill the rest
+    // with mutated copies of it.
+    // Mutation is bit-flip mutation of (mutation_prob * size of bitstring) random bits
+    population.copy(0, population, best);
+    auto number_of_bit_flips = (size_t)std::round(mutation_prob * (double)population.genome(0).size());
+    parallel::for_each_chunk(population.size() - 1, threads, [&](size_t begin, size_t end, size_t chunk)
+                             {
+        for (size_t i = begin + 1; i < end + 1; i++)
+        {
+            population.copy(i, population, 0);
+            seat(rng::Phase::restart, generation, i);
+            auto copy = population.mutable_genome(i);
+            restart_flips[chunk].apply(copy, number_of_bit_flips);
+        } });
+    evaluate(population);
 }
 
 std::vector<GenerationPerformance> CHC::run()
 {
+    start_run();
     std::vector<GenerationPerformance> performance;
     performance.resize(num_of_generations);
-    std::vector<Individual> population = generate_initial_population();
-    for (auto &individual : population)
-    {
-        individual.evaluate();
-    }
+    Population population = generate_initial_population();
+    evaluate(population);
     double difference_threshold = (double)variable_size * (double)number_of_variables / 4.0;
+    // Sized on first use and reused by every generation.
+    Population parents(population.get_schema()), children(population.get_schema()), survivors(population.get_schema());
+    prepare_terms(parents);
+    prepare_terms(children);
+    prepare_terms(survivors);
+    hux.resize(threads);
+    restart_flips.resize(threads);
     for (size_t gen = 0; gen < num_of_generations; gen++)
     {
-        auto parents = select_parents(population);
-        auto children = crossover(parents, difference_threshold);
-        for (auto &individual : children)
-        {
-            individual.evaluate();
-        }
-        auto survivors = select_survivors(parents, children);
-        if (std::is_permutation(survivors.begin(), survivors.end(), population.begin(), population.end()))
+        seat(rng::Phase::selection, gen, 0);
+        select_parents(population, parents);
+        crossover(parents, difference_threshold, children, gen);
+        evaluate(children);
+        select_survivors(parents, children, survivors);
+        if (fingerprint.same_members(survivors, population, std::identity{}))
         {
             difference_threshold -= 1.;
         }
-        population = survivors;
+        std::swap(population, survivors);
         if (difference_threshold < 0)
         {
-            population = diverge_if_converged(survivors);
+            diverge_if_converged(population, gen);
             difference_threshold = mutation_prob * (1. - mutation_prob) * (double)population_size;
         }
 
-        auto best_individual = *std::max_element(
-            population.begin(),
-            population.end());
-        auto worst_individual = *std::min_element(
-            population.begin(),
-            population.end());
-        auto best_fitness = std::get<0>(best_individual.getFitness());
-        auto worst_fitness = std::get<0>(worst_individual.getFitness());
-        auto average_fitness = std::accumulate(
-                                   population.begin(),
-                                   population.end(),
-                                   0.0,
-                                   [](double sum, const Individual &individual) {
-                                       return sum + std::get<0>(individual.getFitness());
-                                   }) /
-                               (double)population_size;
-        auto best_objective_function_value = std::get<1>(best_individual.getFitness());
-        auto worst_objective_function_value = std::get<1>(worst_individual.getFitness());
-        auto average_objective_function_value = std::accumulate(
-                                                    population.begin(),
-                                                    population.end(),
-                                                    0.0,
-                                                    [](double sum, const Individual &individual) {
-                                                        return sum + std::get<1>(individual.getFitness());
-                                                    }) /
-                                                (double)population_size;
+        auto summary = summarize(
+            population_size,
+            [&](size_t i)
+            { return population.fitness(i); },
+            [&](size_t i)
+            { return population.objective(i); });
+        auto best_fitness = population.fitness(summary.best);
+        auto worst_fitness = population.fitness(summary.worst);
+        auto average_fitness = summary.fitness_sum / (double)population_size;
+        auto best_objective_function_value = population.objective(summary.best);
+        auto worst_objective_function_value = population.objective(summary.worst);
+        auto average_objective_function_value = summary.objective_sum / (double)population_size;
         performance[gen] = GenerationPerformance(
             gen,
             best_fitness,
@@ -260,8 +203,14 @@ std::vector<GenerationPerformance> CHC::run()
             best_objective_function_value,
             average_objective_function_value,
             worst_objective_function_value,
-            best_individual.getVector().decode(),
-            worst_individual.getVector().decode());
+            population.decode(summary.best),
+            population.decode(summary.worst));
+        performance[gen].distinct_individuals = fingerprint.count_distinct(population, std::identity{});
+        if (should_stop(performance[gen]) || !end_generation(performance[gen], population))
+        {
+            performance.resize(gen + 1);
+            break;
+        }
     }
     return performance;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "algorithm.hpp"
-extern std::mt19937 &get_generator();
+#include "chc_operators.hpp"
+#include "../random.hpp"
 #include <ranges>
 
 class CHC : public Algorithm
@@ -19,71 +20,79 @@ public:
 private:
     /**
      * @brief Generate an initial population.
-     * @return std::vector<Individual> The initial population.
+     * @return Population The initial population.
      */
-    std::vector<Individual> generate_initial_population();
+    Population generate_initial_population();
 
     /**
      * @brief Select parents from the population.
      * For CHC, the parents are selected randomly, without replacement (shuffle).
+     * Only an index permutation is shuffled; the members are then copied
+     * into the parents' arena in that order.
      * @param population The population.
-     * @return std::vector<Individual> The selected parents.
+     * @param parents The selected parents. Reused between generations.
      */
-    std::vector<Individual> select_parents(const std::vector<Individual> &population);
+    void select_parents(const Population &population, Population &parents);
 
     /**
-     * @brief Find the hamming distance between two individuals.
-     * @param individual1 The first individual.
-     * @param individual2 The second individual.
+     * @brief Find the hamming distance between two members.
+     * @param population The population.
+     * @param first The first member.
+     * @param second The second member.
      * @return size_t The hamming distance.
      */
-    size_t hamming_distance(const Individual &individual1, const Individual &individual2);
-
-    /**
-     * @brief Get indices that are not the same between two vectors.
-     * @param vector1 The first vector.
-     * @param vector2 The second vector.
-     * @return std::vector<size_t> The indices that are not the same.
-     */
-    std::vector<size_t> get_different_indices(
-        const bitstring &vector1,
-        const bitstring &vector2);
+    size_t hamming_distance(const Population &population, size_t first, size_t second);
 
     /**
      * @brief Crossover the parents to generate children.
-     * For CHC, the crossover is uniform crossover.
+     * For CHC, the crossover is half uniform crossover (HUX).
      * @param parents The parents.
      * @param difference_threshold The threshold for the hamming distance.
-     * @return std::vector<Individual> The children.
+     * @param children The children. Reused between generations, so no
+     * genome storage is allocated once it has the population's size.
+     * @param generation The generation, which keys the random streams of the pairs.
      */
-    std::vector<Individual> crossover(
-        const std::vector<Individual> &recomb_parents,
-        double difference_threshold);
+    void crossover(
+        const Population &recomb_parents,
+        double difference_threshold,
+        Population &children,
+        size_t generation);
 
     /**
      * @brief Mutate the children.
      * For CHC, the mutation is bit-flip mutation.
      * @param children The children.
      */
-    void mutate(std::vector<Individual> &children);
+    void mutate(Population &children);
 
     /**
      * @brief Select survivors from the population.
-     * For CHC, the survivors are selected using elitism.
+     * For CHC, the survivors are the best population_size of parents and
+     * children together (elitism). Only fitness keys are compared; the
+     * winning members are then copied into survivors.
+     * @param parents The parents.
      * @param children The children.
-     * @return std::vector<Individual> The survivors.
+     * @param survivors The survivors. Reused between generations.
      */
-    std::vector<Individual> select_survivors(
-        std::vector<Individual> &parents,
-        std::vector<Individual> &children);
+    void select_survivors(
+        const Population &parents,
+        const Population &children,
+        Population &survivors);
 
     /**
      * @brief Diverge if the population has converged.
      * For CHC, the population has converged if all individuals are the same.
-     * This will generate a new population by first copying the best individual
-     * and then mutating all but one of the copies.
+     * This will replace the population in place by first copying the best
+     * individual and then mutating all but one of the copies.
      * @param population The population.
-     * @return std::vector<Individual> The new population.
+     * @param generation The generation, which keys the random streams of the copies.
      */
-    std::vector<Individual> diverge_if_converged(const std::vector<Individual> &population);
+    void diverge_if_converged(Population &population, size_t generation);
+
+    // The parent permutation of select_parents().
+    std::vector<size_t> order;
+    // One operator (and its scratch buffers) per thread.
+    std::vector<HUXCrossover> hux;
+    std::vector<RandomBitFlips> restart_flips;
+    ElitistSelection elitist_selection;
 };
\ No newline at end of file
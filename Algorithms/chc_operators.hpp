@@ -0,0 +1,171 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <cassert>
+
+#include "../bitstring.hpp"
+
+#include "../random.hpp"
+
+/**
+ * Half-uniform crossover (HUX) on packed words.
+ * Exactly half (rounded down) of the bits in which the two parents differ,
+ * chosen uniformly at random, are exchanged between them. The differing
+ * positions are collected into a scratch buffer that is reused across calls,
+ * so once it has grown to the genome size (see reserve()) no memory is
+ * allocated.
+ */
+class HUXCrossover
+{
+private:
+    std::vector<size_t> differing;
+
+public:
+    /**
+     * @brief Grow the scratch buffer for genomes of up to the given size, so no call allocates.
+     */
+    void reserve(size_t bits)
+    {
+        differing.reserve(bits);
+    }
+
+    /**
+     * @brief Cross two genomes in place.
+     * @param a The first genome (bitstring or StaticGenome).
+     * @param b The second genome, of the same size.
+     * @return The number of exchanged bits.
+     */
+    template <typename Genome>
+    size_t apply(Genome &a, Genome &b)
+    {
+        assert(a.size() == b.size());
+        auto words_a = a.get_words();
+        auto words_b = b.get_words();
+        differing.clear();
+        for (size_t w = 0; w < words_a.size(); w++)
+        {
+            for (auto diff = words_a[w] ^ words_b[w]; diff != 0; diff &= diff - 1)
+            {
+                differing.push_back(w * bitops::word_bits + bitops::word_bits - 1 - (size_t)std::countr_zero(diff));
+            }
+        }
+        // Partial Fisher-Yates: the first half of the buffer becomes a uniform random subset.
+        auto half = differing.size() / 2;
+        auto &generator = get_generator();
+        for (size_t k = 0; k < half; k++)
+        {
+            std::swap(differing[k], differing[k + generator.bounded(differing.size() - k)]);
+            a.flip(differing[k]);
+            b.flip(differing[k]);
+        }
+        return half;
+    }
+};
+
+/**
+ * Flip a fixed number of distinct, uniformly chosen bits of a genome.
+ * Used by the CHC cataclysmic restart. The positions come from a partial
+ * Fisher-Yates shuffle of the identity permutation, which is kept between
+ * calls: the swaps are undone afterwards in O(count), so nothing is
+ * allocated or re-initialized per individual and the chosen bits depend
+ * only on the generator, not on earlier calls.
+ */
+class RandomBitFlips
+{
+private:
+    std::vector<size_t> permutation;
+    std::vector<size_t> picks;
+
+public:
+    /**
+     * @brief Set up the permutation for genomes of the given size, so no call allocates.
+     */
+    void reserve(size_t bits)
+    {
+        permutation.resize(bits);
+        std::iota(permutation.begin(), permutation.end(), 0);
+        picks.reserve(bits);
+    }
+
+    /**
+     * @brief Flip count distinct random bits.
+     * @param genome The genome (bitstring or StaticGenome).
+     * @param count The number of bits to flip, at most the genome's size.
+     */
+    template <typename Genome>
+    void apply(Genome &genome, size_t count)
+    {
+        auto bits = genome.size();
+        assert(count <= bits);
+        if (permutation.size() != bits)
+        {
+            permutation.resize(bits);
+            std::iota(permutation.begin(), permutation.end(), 0);
+        }
+        picks.resize(count);
+        auto &generator = get_generator();
+        for (size_t k = 0; k < count; k++)
+        {
+            picks[k] = k + generator.bounded(bits - k);
+            std::swap(permutation[k], permutation[picks[k]]);
+            genome.flip(permutation[k]);
+        }
+        // Back to the identity.
+        for (size_t k = count; k-- > 0;)
+        {
+            std::swap(permutation[k], permutation[picks[k]]);
+        }
+    }
+};
+
+/**
+ * Elitist (mu + lambda) survivor selection on compact keys.
+ * Only (fitness, index) pairs are partitioned, with std::nth_element, so
+ * selecting the survivors is O(n) on average and no genome is copied until
+ * the caller moves the winners into place. On equal fitness children win
+ * over parents.
+ */
+class ElitistSelection
+{
+public:
+    struct Key
+    {
+        double fitness;
+        // Index into the parents, or parents + index into the children.
+        size_t index;
+    };
+
+private:
+    std::vector<Key> keys;
+
+public:
+    /**
+     * @brief Choose the best count members of parents and children.
+     * @param parents The number of parents.
+     * @param children The number of children.
+     * @param count The number of survivors.
+     * @param fitness_of Maps a key index (parents first, then children) to its fitness.
+     * @return The keys of the survivors, in no particular order. Valid until the next call.
+     */
+    template <typename FitnessOf>
+    std::span<const Key> select(size_t parents, size_t children, size_t count, FitnessOf fitness_of)
+    {
+        assert(count <= parents + children);
+        keys.resize(parents + children);
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            keys[i] = {fitness_of(i), i};
+        }
+        std::nth_element(keys.begin(), keys.begin() + (std::ptrdiff_t)count, keys.end(), [parents](const Key &a, const Key &b)
+                         {
+                             if (a.fitness != b.fitness)
+                             {
+                                 return a.fitness > b.fitness;
+                             }
+                             return (a.index >= parents) > (b.index >= parents); });
+        return std::span<const Key>(keys).first(count);
+    }
+};
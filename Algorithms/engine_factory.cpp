@@ -0,0 +1,107 @@
+#include "engine_factory.hpp"
+#include "simple_ga.hpp"
+#include "chc.hpp"
+#include "static_simple_ga.hpp"
+#include "static_chc.hpp"
+#include "lockstep_simple_ga.hpp"
+#include "../Functions/dejong.hpp"
+
+namespace
+{
+    /**
+     * A configuration with a compile-time specialized engine.
+     */
+    template <typename Function, size_t VariableSize, size_t NumberOfVariables>
+    struct Specialization
+    {
+        template <typename Interface, template <typename, size_t, size_t> class Engine, typename... Options>
+        static std::unique_ptr<Interface> make(
+            size_t pop_size,
+            size_t num_of_gens,
+            double crossover_p,
+            double mutation_p,
+            size_t variable_size,
+            size_t num_of_variables,
+            OptimizationFunction &func,
+            Options... options)
+        {
+            auto *concrete = dynamic_cast<Function *>(&func);
+            if (concrete == nullptr || variable_size != VariableSize || num_of_variables != NumberOfVariables)
+            {
+                return nullptr;
+            }
+            return std::make_unique<Engine<Function, VariableSize, NumberOfVariables>>(pop_size, num_of_gens, crossover_p, mutation_p, *concrete, options...);
+        }
+    };
+
+    // The configurations run by main.cpp.
+    template <typename... Specializations>
+    struct SpecializationList
+    {
+        template <typename Interface, template <typename, size_t, size_t> class Engine, typename... Args>
+        static std::unique_ptr<Interface> make(Args &&...args)
+        {
+            std::unique_ptr<Interface> algorithm;
+            ((algorithm = algorithm ? std::move(algorithm) : Specializations::template make<Interface, Engine>(args...)), ...);
+            return algorithm;
+        }
+    };
+
+    using Production = SpecializationList<
+        Specialization<dejong::DeJong1, 32, 3>,
+        Specialization<dejong::DeJong2, 32, 2>,
+        Specialization<dejong::DeJong3, 32, 5>,
+        Specialization<dejong::DeJong4, 32, 10>,
+        Specialization<dejong::DeJong5, 32, 2>>;
+}
+
+std::unique_ptr<Algorithm> make_simple_ga(
+    size_t pop_size,
+    size_t num_of_gens,
+    double crossover_p,
+    double mutation_p,
+    size_t variable_size,
+    size_t num_of_variables,
+    OptimizationFunction &func,
+    SelectionStrategy selection_strategy,
+    size_t tournament_size)
+{
+    auto algorithm = Production::make<Algorithm, StaticSimpleGA>(pop_size, num_of_gens, crossover_p, mutation_p, variable_size, num_of_variables, func, selection_strategy, tournament_size);
+    if (!algorithm)
+    {
+        algorithm = std::make_unique<SimpleGA>(pop_size, num_of_gens, crossover_p, mutation_p, variable_size, num_of_variables, func, selection_strategy, tournament_size);
+    }
+    return algorithm;
+}
+
+std::unique_ptr<Algorithm> make_chc(
+    size_t pop_size,
+    size_t num_of_gens,
+    double crossover_p,
+    double mutation_p,
+    size_t variable_size,
+    size_t num_of_variables,
+    OptimizationFunction &func)
+{
+    auto algorithm = Production::make<Algorithm, StaticCHC>(pop_size, num_of_gens, crossover_p, mutation_p, variable_size, num_of_variables, func);
+    if (!algorithm)
+    {
+        algorithm = std::make_unique<CHC>(pop_size, num_of_gens, crossover_p, mutation_p, variable_size, num_of_variables, func);
+    }
+    return algorithm;
+}
+
+std::unique_ptr<LockstepAlgorithm> make_lockstep_simple_ga(
+    size_t pop_size,
+    size_t num_of_gens,
+    double crossover_p,
+    double mutation_p,
+    size_t variable_size,
+    size_t num_of_variables,
+    OptimizationFunction &func,
+    size_t runs,
+    SelectionStrategy selection_strategy,
+    size_t tournament_size)
+{
+    return Production::make<LockstepAlgorithm, LockstepSimpleGA>(pop_size, num_of_gens, crossover_p, mutation_p, variable_size, num_of_variables, func, runs, selection_strategy, tournament_size);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <memory>
+
+#include "algorithm.hpp"
+#include "selection.hpp"
+#include "lockstep_simple_ga.hpp"
+
+/**
+ * @brief Create a SimpleGA for the given configuration.
+ * Configurations used in production (a De Jong function with 32 bits per
+ * variable) get a compile-time specialized engine; everything else falls
+ * back to the runtime-polymorphic SimpleGA. Specialized engines evaluate
+ * on the run's threads and ignore set_executor().
+ */
+std::unique_ptr<Algorithm> make_simple_ga(
+    size_t pop_size,
+    size_t num_of_gens,
+    double crossover_p,
+    double mutation_p,
+    size_t variable_size,
+    size_t num_of_variables,
+    OptimizationFunction &func,
+    SelectionStrategy selection_strategy = SelectionStrategy::proportional,
+    size_t tournament_size = 2);
+
+/**
+ * @brief Create a CHC for the given configuration.
+ * Specialized and fallback engines are chosen as in make_simple_ga.
+ */
+std::unique_ptr<Algorithm> make_chc(
+    size_t pop_size,
+    size_t num_of_gens,
+    double crossover_p,
+    double mutation_p,
+    size_t variable_size,
+    size_t num_of_variables,
+    OptimizationFunction &func);
+
+/**
+ * @brief Create an engine that evolves several runs of a SimpleGA in lockstep.
+ * Only the production configurations have one; returns nullptr for the
+ * rest, which run one make_simple_ga engine per run instead.
+ * @param runs The number of runs (lanes).
+ */
+std::unique_ptr<LockstepAlgorithm> make_lockstep_simple_ga(
+    size_t pop_size,
+    size_t num_of_gens,
+    double crossover_p,
+    double mutation_p,
+    size_t variable_size,
+    size_t num_of_variables,
+    OptimizationFunction &func,
+    size_t runs,
+    SelectionStrategy selection_strategy = SelectionStrategy::proportional,
+    size_t tournament_size = 2);
@@ -0,0 +1,285 @@
+#include "island_model.hpp"
+#include "simple_ga.hpp"
+#include "chc.hpp"
+#include <thread>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+
+IslandModel::IslandModel(
+    IslandEngine engine,
+    size_t islands,
+    size_t pop_size,
+    size_t num_of_gens,
+    double crossover_p,
+    double mutation_p,
+    size_t variable_size,
+    size_t num_of_variables,
+    OptimizationFunction &func,
+    size_t migration_interval,
+    size_t migrants,
+    MigrationTopology topology) : Algorithm(pop_size, num_of_gens, crossover_p, mutation_p, variable_size, num_of_variables, func),
+                                  engine(engine),
+                                  islands(islands),
+                                  migration_interval(migration_interval),
+                                  migrants(migrants),
+                                  topology(topology)
+{
+    check_initialization();
+}
+
+std::unique_ptr<Algorithm> IslandModel::make_island(size_t island) const
+{
+    std::unique_ptr<Algorithm> algorithm;
+    if (engine == IslandEngine::chc)
+    {
+        algorithm = std::make_unique<CHC>(population_size, num_of_generations, crossover_prob, mutation_prob, variable_size, number_of_variables, function);
+    }
+    else
+    {
+        algorithm = std::make_unique<SimpleGA>(population_size, num_of_generations, crossover_prob, mutation_prob, variable_size, number_of_variables, function);
+    }
+    algorithm->set_threads(std::max<size_t>(1, threads / islands));
+    algorithm->set_seed(seed, run_index * islands + island);
+    algorithm->set_cache(cache);
+    algorithm->set_delta_evaluation(delta_evaluation);
+    algorithm->set_executor(executor);
+    return algorithm;
+}
+
+size_t IslandModel::readers() const
+{
+    return topology == MigrationTopology::fully_connected ? islands - 1 : 1;
+}
+
+void IslandModel::find_sources(size_t island, uint64_t migration, Route &route) const
+{
+    route.sources.clear();
+    switch (topology)
+    {
+    case MigrationTopology::ring:
+        route.sources.push_back((island + islands - 1) % islands);
+        break;
+    case MigrationTopology::fully_connected:
+        for (size_t other = 0; other < islands; other++)
+        {
+            if (other != island)
+            {
+                route.sources.push_back(other);
+            }
+        }
+        break;
+    case MigrationTopology::random:
+    {
+        // Every island draws the same ring from the migration's stream.
+        auto generator = stream(rng::Phase::migration, migration, 0);
+        std::iota(route.order.begin(), route.order.end(), 0);
+        std::shuffle(route.order.begin(), route.order.end(), generator);
+        auto position = (size_t)(std::find(route.order.begin(), route.order.end(), island) - route.order.begin());
+        route.sources.push_back(route.order[(position + islands - 1) % islands]);
+        break;
+    }
+    }
+}
+
+void IslandModel::migrate(size_t island, uint64_t migration, Population &population)
+{
+    auto &route = routes[island];
+    // Rank the members once: the first ones leave, the last ones are replaced.
+    std::iota(route.ranking.begin(), route.ranking.end(), 0);
+    std::sort(route.ranking.begin(), route.ranking.end(), [&](size_t a, size_t b)
+              { return population.fitness(a) > population.fitness(b) || (population.fitness(a) == population.fitness(b) && a < b); });
+
+    // Publish, once every reader has taken the migrants this slot held two migrations ago.
+    auto slot = migration % 2;
+    auto &outbox = *outboxes[island];
+    while (outbox.reads[slot].load(std::memory_order_acquire) < readers() * (migration / 2))
+    {
+        std::this_thread::yield();
+    }
+    for (size_t k = 0; k < migrants; k++)
+    {
+        outbox.slots[slot].copy(k, population, route.ranking[k]);
+    }
+    outbox.published.store(migration + 1, std::memory_order_release);
+
+    // Take in the sources' migrants as soon as each has published them.
+    find_sources(island, migration, route);
+    auto replaced = population.size();
+    for (auto source : route.sources)
+    {
+        auto &inbox = *outboxes[source];
+        while (inbox.published.load(std::memory_order_acquire) < migration + 1)
+        {
+            std::this_thread::yield();
+        }
+        for (size_t k = 0; k < migrants; k++)
+        {
+            population.copy(route.ranking[--replaced], inbox.slots[slot], k);
+        }
+        inbox.reads[slot].fetch_add(1, std::memory_order_release);
+    }
+}
+
+std::vector<GenerationPerformance> IslandModel::merge(const std::vector<std::vector<GenerationPerformance>> &series) const
+{
+    // The islands stop together, so their series are as long as each other.
+    std::vector<GenerationPerformance> performance(series.front().size());
+    for (size_t generation = 0; generation < performance.size(); generation++)
+    {
+        size_t best = 0, worst = 0;
+        double average_fitness = 0.0, average_objective = 0.0;
+        size_t distinct = 0;
+        for (size_t island = 0; island < islands; island++)
+        {
+            const auto &record = series[island][generation];
+            best = record.best_fitness > series[best][generation].best_fitness ? island : best;
+            worst = record.worst_fitness < series[worst][generation].worst_fitness ? island : worst;
+            average_fitness += record.average_fitness;
+            average_objective += record.average_objective_function_value;
+            distinct += record.distinct_individuals;
+        }
+        const auto &best_record = series[best][generation];
+        const auto &worst_record = series[worst][generation];
+        performance[generation] = GenerationPerformance(
+            generation,
+            best_record.best_fitness,
+            average_fitness / (double)islands,
+            worst_record.worst_fitness,
+            best_record.best_objective_function_value,
+            average_objective / (double)islands,
+            worst_record.worst_objective_function_value,
+            best_record.best_solution,
+            worst_record.worst_solution);
+        performance[generation].distinct_individuals = distinct;
+    }
+    return performance;
+}
+
+std::vector<GenerationPerformance> IslandModel::run()
+{
+    start_run();
+    GenomeSchema schema(variable_size, number_of_variables, function);
+    outboxes.clear();
+    routes.assign(islands, Route{});
+    for (size_t island = 0; island < islands; island++)
+    {
+        outboxes.push_back(std::make_unique<Outbox>(schema, migrants));
+        routes[island].ranking.resize(population_size);
+        routes[island].sources.reserve(islands - 1);
+        routes[island].order.resize(islands);
+    }
+
+    std::vector<std::vector<GenerationPerformance>> series(islands);
+    std::vector<uint64_t> allocations(islands);
+    progress.assign(islands, std::vector<Progress>(num_of_generations));
+    checked = 0;
+    stop_generation = num_of_generations;
+    arrivals.store(0, std::memory_order_relaxed);
+    decisions.store(0, std::memory_order_relaxed);
+    stop.store(false, std::memory_order_relaxed);
+    auto checks_stopping = stopping.get_criteria().any();
+    {
+        std::vector<std::jthread> workers;
+        for (size_t island = 0; island < islands; island++)
+        {
+            workers.emplace_back([&, island]
+                                 {
+                auto algorithm = make_island(island);
+                algorithm->set_generation_hook([&, island](const GenerationPerformance &record, Population &population)
+                                               {
+                    auto generation = record.generation;
+                    progress[island][generation] = {record.best_fitness, record.best_objective_function_value, record.distinct_individuals, algorithm->get_evaluations(), stopping.elapsed()};
+                    // No migration after the last generation: nothing is bred from it.
+                    if ((generation + 1) % migration_interval != 0 || generation + 1 == num_of_generations)
+                    {
+                        return true;
+                    }
+                    auto migration = (generation + 1) / migration_interval - 1;
+                    if (checks_stopping && !agree(migration, generation))
+                    {
+                        return false;
+                    }
+                    migrate(island, migration, population);
+                    return true; });
+                series[island] = algorithm->run();
+                allocations[island] = algorithm->get_steady_state_allocations(); });
+        }
+    }
+    for (auto count : allocations)
+    {
+        steady_state_allocations += count;
+    }
+
+    auto performance = merge(series);
+    if (stop_generation == num_of_generations)
+    {
+        check_stopping(performance.size() - 1);
+    }
+    auto last = std::min(stop_generation, performance.size() - 1);
+    performance.resize(last + 1);
+    evaluation_count = 0;
+    for (size_t island = 0; island < islands; island++)
+    {
+        evaluation_count += progress[island][last].evaluations;
+    }
+    return performance;
+}
+
+bool IslandModel::agree(uint64_t migration, size_t generation)
+{
+    if (arrivals.fetch_add(1, std::memory_order_acq_rel) + 1 == islands * (migration + 1))
+    {
+        // Every island has recorded the generation; no island writes progress until the decision.
+        stop.store(check_stopping(generation), std::memory_order_relaxed);
+        decisions.store(migration + 1, std::memory_order_release);
+    }
+    else
+    {
+        while (decisions.load(std::memory_order_acquire) < migration + 1)
+        {
+            std::this_thread::yield();
+        }
+    }
+    return !stop.load(std::memory_order_relaxed);
+}
+
+bool IslandModel::check_stopping(size_t until)
+{
+    for (; checked <= until; checked++)
+    {
+        // The best objective is that of the island with the best fitness, as in merge().
+        size_t best = 0, distinct = 0;
+        uint64_t evaluations = 0;
+        std::chrono::steady_clock::duration elapsed{};
+        for (size_t island = 0; island < islands; island++)
+        {
+            const auto &record = progress[island][checked];
+            best = record.best_fitness > progress[best][checked].best_fitness ? island : best;
+            distinct += record.distinct_individuals;
+            evaluations += record.evaluations;
+            elapsed = std::max(elapsed, record.elapsed);
+        }
+        if (stopping.should_stop(progress[best][checked].best_objective, distinct, evaluations, elapsed, function.getMinY(), function.isDeterministic()))
+        {
+            stop_generation = checked;
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifndef NDEBUG
+void IslandModel::check_initialization()
+{
+    assert(islands > 1);
+    assert(population_size > 0);
+    assert(num_of_generations > 0);
+    assert(migration_interval > 0);
+    assert(migrants > 0);
+    // The members sent must not be among those replaced.
+    assert(migrants * (readers() + 1) <= population_size);
+}
+#else
+void IslandModel::check_initialization() {}
+#endif
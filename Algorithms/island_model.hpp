@@ -0,0 +1,194 @@
+#pragma once
+#include "algorithm.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+
+/**
+ * The algorithm every island of an IslandModel runs.
+ */
+enum class IslandEngine
+{
+    simple_ga,
+    chc
+};
+
+/**
+ * Where the migrants of an island go.
+ */
+enum class MigrationTopology
+{
+    // Island i sends to island i + 1, the last to the first.
+    ring,
+    // Every island sends to every other island.
+    fully_connected,
+    // A ring over a random order of the islands, drawn anew for every migration.
+    random
+};
+
+/**
+ * Several SimpleGA or CHC populations (islands) evolving in parallel, one
+ * thread each, that exchange their best members every few generations.
+ * At a migration every island publishes copies of its best members, then
+ * replaces its worst members with those published by its sources in the
+ * topology. The islands meet only at the exchange buffers: each island
+ * owns one, double-buffered, with atomic counters for publication and
+ * reads, so a fast island only waits for the migrants it needs and never
+ * takes a lock. The migrants and their routes depend only on the seed, so
+ * a run is reproducible although the islands run freely.
+ *
+ * The series of the model has one record per generation over all islands:
+ * best and worst of all, averages over all members, and distinct genomes
+ * summed over the islands. Stopping criteria are checked on that series,
+ * with the evaluations of all islands, at every migration: the last island
+ * to arrive checks the generations since the one before, and if they meet
+ * the criteria it raises a shared stop flag that every island reads before
+ * migrating, so all of them stop at the same generation. Generations after
+ * the last migration are checked once the islands are done. The series is
+ * cut where the criteria are met.
+ */
+class IslandModel : public Algorithm
+{
+public:
+    /**
+     * @param engine The algorithm of every island.
+     * @param islands The number of islands, each on its own thread.
+     * @param pop_size The population size of one island.
+     * @param migration_interval The number of generations between migrations.
+     * @param migrants The number of members each island sends per migration.
+     * @param topology Where the migrants go.
+     */
+    IslandModel(
+        IslandEngine engine,
+        size_t islands,
+        size_t pop_size,
+        size_t num_of_gens,
+        double crossover_p,
+        double mutation_p,
+        size_t variable_size,
+        size_t num_of_variables,
+        OptimizationFunction &func,
+        size_t migration_interval,
+        size_t migrants,
+        MigrationTopology topology = MigrationTopology::ring);
+
+    /**
+     * @brief Evolve the islands.
+     * Threads set with set_threads() are split between the islands; every
+     * island runs on a thread of its own either way, since islands wait
+     * for each other's migrants. Island k draws from the streams of run
+     * run * islands + k of the seed.
+     */
+    std::vector<GenerationPerformance> run() override;
+
+private:
+    /**
+     * The migrants of one island, double-buffered: migration m is written
+     * to slot m % 2. published counts the migrations written, reads[s] the
+     * reads of slot s, so a slot is only rewritten once every source has
+     * taken the migrants it held before.
+     */
+    struct Outbox
+    {
+        std::array<Population, 2> slots;
+        alignas(64) std::atomic<uint64_t> published = 0;
+        alignas(64) std::array<std::atomic<uint64_t>, 2> reads{};
+
+        explicit Outbox(const GenomeSchema &schema, size_t migrants) : slots{Population(schema, migrants), Population(schema, migrants)} {}
+    };
+
+    /**
+     * The scratch buffers of one island's migrations, sized before the islands start.
+     */
+    struct Route
+    {
+        // Member indices from best to worst.
+        std::vector<size_t> ranking;
+        // The islands this island receives from.
+        std::vector<size_t> sources;
+        // The random ring of a MigrationTopology::random migration.
+        std::vector<size_t> order;
+    };
+
+    /**
+     * What the stopping criteria need of one island's generation.
+     */
+    struct Progress
+    {
+        double best_fitness = 0.0;
+        double best_objective = 0.0;
+        size_t distinct_individuals = 0;
+        uint64_t evaluations = 0;
+        std::chrono::steady_clock::duration elapsed{};
+    };
+
+    IslandEngine engine;
+    size_t islands;
+    size_t migration_interval;
+    size_t migrants;
+    MigrationTopology topology;
+    std::vector<std::unique_ptr<Outbox>> outboxes;
+    std::vector<Route> routes;
+    // The progress of every island at every generation.
+    std::vector<std::vector<Progress>> progress;
+    // The generations checked against the stopping criteria, and the one that met them, if any.
+    size_t checked = 0;
+    size_t stop_generation = 0;
+    // The islands that reached a migration, over all migrations, and the migrations decided.
+    alignas(64) std::atomic<uint64_t> arrivals = 0;
+    alignas(64) std::atomic<uint64_t> decisions = 0;
+    std::atomic<bool> stop = false;
+
+    /**
+     * @brief Create the algorithm of one island.
+     */
+    std::unique_ptr<Algorithm> make_island(size_t island) const;
+
+    /**
+     * @brief Get the number of islands receiving the migrants of each island.
+     */
+    size_t readers() const;
+
+    /**
+     * @brief Find the islands one island receives from in a migration.
+     * @param island The receiving island.
+     * @param migration The index of the migration.
+     * @param route The island's scratch buffers; receives the sources.
+     */
+    void find_sources(size_t island, uint64_t migration, Route &route) const;
+
+    /**
+     * @brief Publish an island's best members, then take in its sources' migrants.
+     * The migrants replace the worst members, evaluation included.
+     * @param island The island.
+     * @param migration The index of the migration.
+     * @param population The island's population.
+     */
+    void migrate(size_t island, uint64_t migration, Population &population);
+
+    /**
+     * @brief Wait until every island has reached a migration and learn whether they stop there.
+     * The last island to arrive checks the stopping criteria.
+     * @param migration The index of the migration.
+     * @param generation The generation the migration follows.
+     * @return Whether the islands go on.
+     */
+    bool agree(uint64_t migration, size_t generation);
+
+    /**
+     * @brief Check the generations up to one against the stopping criteria, merged over the islands.
+     * Sets stop_generation to the first that meets them.
+     * @return Whether one met them.
+     */
+    bool check_stopping(size_t until);
+
+    /**
+     * @brief Combine the series of the islands into one.
+     */
+    std::vector<GenerationPerformance> merge(const std::vector<std::vector<GenerationPerformance>> &series) const;
+
+    /**
+     * @brief Debug assertions to check if initializations are correct.
+     */
+    void check_initialization();
+};
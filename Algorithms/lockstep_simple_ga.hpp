@@ -0,0 +1,652 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <span>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#include "algorithm.hpp"
+#include "selection.hpp"
+#include "../population.hpp"
+#include "../static_genome.hpp"
+
+/**
+ * Several independent runs of one configuration, evolved together.
+ * Run first_run + lane of the experiment is lane lane of the engine; every
+ * random draw of a lane comes from the same stream as in a run of its own
+ * (Algorithm::set_seed with that run index), so each lane's series is the
+ * one the per-run engine produces.
+ */
+class LockstepAlgorithm
+{
+protected:
+    size_t lanes;
+    // The number of threads run() may use, see set_threads().
+    size_t threads = 1;
+    // The experiment seed and the run index of lane 0, see set_seed().
+    uint64_t seed = rng::random_seed();
+    uint64_t first_run = 0;
+
+    /**
+     * @brief Seat the calling thread's generator on the stream of one unit of work of one lane.
+     */
+    void seat(size_t lane, rng::Phase phase, uint64_t generation, uint64_t slot) const
+    {
+        get_generator() = rng::Stream(this->seed, phase, this->first_run + lane, generation, slot);
+    }
+
+public:
+    explicit LockstepAlgorithm(size_t runs) : lanes(runs)
+    {
+        assert(runs > 0);
+    }
+    virtual ~LockstepAlgorithm() = default;
+
+    /**
+     * @brief Evolve every lane.
+     * @return The series of every lane, in lane order.
+     */
+    virtual std::vector<std::vector<GenerationPerformance>> run() = 0;
+
+    size_t get_runs() const { return this->lanes; }
+
+    /**
+     * @brief Set the number of threads run() may use, as Algorithm::set_threads.
+     */
+    void set_threads(size_t run_threads)
+    {
+        assert(run_threads > 0);
+        this->threads = run_threads;
+    }
+
+    /**
+     * @brief Make run() reproducible.
+     * @param experiment_seed The seed shared by all runs of an experiment.
+     * @param first The run index of lane 0; lane i is run first + i.
+     */
+    void set_seed(uint64_t experiment_seed, uint64_t first)
+    {
+        this->seed = experiment_seed;
+        this->first_run = first;
+    }
+};
+
+/**
+ * The populations of several runs with the run as the innermost dimension.
+ * Word w of member i of lane l is words[(i * word_count + w) * lanes + l],
+ * and hashes, fitness, objective values and evaluated flags of member i are
+ * lanes consecutive entries at i * lanes. Loops over the lanes of one member
+ * (decoding, evaluation, statistics) therefore read contiguous memory and
+ * vectorize across runs.
+ * @tparam VariableSize The number of bits per variable.
+ * @tparam NumberOfVariables The number of variables.
+ */
+template <size_t VariableSize, size_t NumberOfVariables>
+class LanePopulation
+{
+public:
+    static constexpr size_t bits = VariableSize * NumberOfVariables;
+    static constexpr size_t word_count = bitops::words_for(bits);
+
+    /**
+     * One lane's genome of one member, its words strided by the lane count.
+     * Offers the genome interface GeometricMutation and PopulationFingerprint use.
+     */
+    template <bool Mutable>
+    class BasicLaneGenome
+    {
+        using Word = std::conditional_t<Mutable, uint64_t, const uint64_t>;
+
+        Word *words;
+        Word *hash_value;
+        size_t stride;
+
+    public:
+        BasicLaneGenome(Word *words, Word *hash_value, size_t stride) : words(words), hash_value(hash_value), stride(stride) {}
+
+        static constexpr size_t size() { return bits; }
+        uint64_t word(size_t w) const { return this->words[w * this->stride]; }
+        uint64_t hash() const { return *this->hash_value; }
+
+        bool operator==(const BasicLaneGenome &other) const
+        {
+            if (hash() != other.hash())
+            {
+                return false;
+            }
+            for (size_t w = 0; w < word_count; w++)
+            {
+                if (word(w) != other.word(w))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Flip the bits of one word selected by a mask, updating the hash incrementally.
+         */
+        void xor_word(size_t w, uint64_t mask)
+            requires Mutable
+        {
+            assert(w + 1 < word_count || (mask & ~bitops::tail_mask(bits)) == 0);
+            auto &target = this->words[w * this->stride];
+            auto old = target;
+            target ^= mask;
+            *this->hash_value ^= bitops::mix(old, w) ^ bitops::mix(target, w);
+        }
+
+        void flip(size_t index)
+            requires Mutable
+        {
+            assert(index < bits);
+            xor_word(index / bitops::word_bits, bitops::mask_of(index));
+        }
+    };
+
+    using LaneGenome = BasicLaneGenome<true>;
+    using ConstLaneGenome = BasicLaneGenome<false>;
+
+    /**
+     * The members of one lane, as a range for PopulationFingerprint.
+     */
+    struct Lane
+    {
+        const LanePopulation *population;
+        size_t lane;
+
+        size_t size() const { return this->population->size(); }
+        ConstLaneGenome operator[](size_t member) const { return this->population->genome(member, this->lane); }
+    };
+
+private:
+    size_t count;
+    size_t lanes;
+    std::vector<uint64_t, AlignedAllocator<uint64_t>> words;
+    std::vector<uint64_t> hashes;
+
+    size_t first_word(size_t member, size_t lane) const
+    {
+        assert(member < this->count && lane < this->lanes);
+        return member * word_count * this->lanes + lane;
+    }
+
+    // Exchange every bit from point onwards between to and a mutable from,
+    // or overwrite them in to with those of a const from.
+    template <typename Source>
+    static bool cross_tail(LaneGenome to, Source from, size_t point)
+    {
+        auto changed = false;
+        for (auto w = point / bitops::word_bits; w < word_count; w++)
+        {
+            auto diff = to.word(w) ^ from.word(w);
+            if (w == point / bitops::word_bits)
+            {
+                diff &= ~uint64_t{0} >> (point % bitops::word_bits);
+            }
+            if (diff != 0)
+            {
+                to.xor_word(w, diff);
+                if constexpr (std::is_same_v<Source, LaneGenome>)
+                {
+                    from.xor_word(w, diff);
+                }
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    // Group group of a word pair of one lane, as bitops::extract reads it.
+    static uint64_t group_bits(uint64_t low, uint64_t high, size_t group)
+    {
+        auto offset = group * VariableSize % bitops::word_bits;
+        auto val = low << offset;
+        if (offset + VariableSize > bitops::word_bits)
+        {
+            val |= high >> (bitops::word_bits - offset);
+        }
+        return val >> (bitops::word_bits - VariableSize);
+    }
+
+public:
+    std::vector<double> fitness;
+    std::vector<double> objective;
+    // Whether fitness and objective belong to the current genome.
+    std::vector<uint8_t> evaluated;
+
+    /**
+     * @brief Create all-zero, unevaluated populations.
+     * @param size The number of members per lane.
+     * @param lanes The number of lanes (runs).
+     */
+    LanePopulation(size_t size, size_t lanes) : count(size),
+                                                lanes(lanes),
+                                                words(size * word_count * lanes),
+                                                hashes(size * lanes, bitops::hash(std::array<uint64_t, word_count>{})),
+                                                fitness(size * lanes),
+                                                objective(size * lanes),
+                                                evaluated(size * lanes) {}
+
+    size_t size() const { return this->count; }
+    size_t get_lanes() const { return this->lanes; }
+
+    /**
+     * @brief Get the index of a member's lane in the per-member arrays.
+     */
+    size_t at(size_t member, size_t lane) const { return member * this->lanes + lane; }
+
+    LaneGenome genome(size_t member, size_t lane)
+    {
+        return LaneGenome(&this->words[first_word(member, lane)], &this->hashes[at(member, lane)], this->lanes);
+    }
+    ConstLaneGenome genome(size_t member, size_t lane) const
+    {
+        return ConstLaneGenome(&this->words[first_word(member, lane)], &this->hashes[at(member, lane)], this->lanes);
+    }
+
+    /**
+     * @brief Draw a member's genome from the calling thread's generator, as StaticGenome::randomize.
+     */
+    void randomize(size_t member, size_t lane)
+    {
+        std::array<uint64_t, word_count> drawn;
+        get_generator().fill(drawn);
+        drawn.back() &= bitops::tail_mask(bits);
+        auto first = first_word(member, lane);
+        for (size_t w = 0; w < word_count; w++)
+        {
+            this->words[first + w * this->lanes] = drawn[w];
+        }
+        this->hashes[at(member, lane)] = bitops::hash(drawn);
+        this->evaluated[at(member, lane)] = false;
+    }
+
+    /**
+     * @brief Copy one lane of a member, evaluation included, from another population of the same shape.
+     */
+    void copy(size_t to, const LanePopulation &from, size_t index, size_t lane)
+    {
+        auto target = first_word(to, lane), source = from.first_word(index, lane);
+        for (size_t w = 0; w < word_count; w++)
+        {
+            this->words[target + w * this->lanes] = from.words[source + w * this->lanes];
+        }
+        auto i = at(to, lane), j = from.at(index, lane);
+        this->hashes[i] = from.hashes[j];
+        this->fitness[i] = from.fitness[j];
+        this->objective[i] = from.objective[j];
+        this->evaluated[i] = from.evaluated[j];
+    }
+
+    /**
+     * @brief One-point crossover of one lane of two members.
+     * @return Whether the genomes changed.
+     */
+    bool swap_tail(size_t first, size_t second, size_t lane, size_t point)
+    {
+        return cross_tail(genome(first, lane), genome(second, lane), point);
+    }
+
+    /**
+     * @brief Overwrite the tail of one lane of a member with that of a member of another population.
+     * One-point crossover for a child whose sibling is not kept.
+     * @return Whether the genome changed.
+     */
+    bool copy_tail(size_t to, const LanePopulation &from, size_t index, size_t lane, size_t point)
+    {
+        return cross_tail(genome(to, lane), from.genome(index, lane), point);
+    }
+
+    /**
+     * @brief Decode every lane of a member into consecutive columns of a matrix.
+     * Each value matches BatchDecoder and StaticGenome::decode exactly.
+     * @param out The matrix; lane l goes to column column + l.
+     */
+    void decode(size_t member, double min, double max, DecodedPopulation &out, size_t column) const
+    {
+        assert(out.get_variables() == NumberOfVariables && column + this->lanes <= out.get_columns());
+        constexpr double full = (double)(~uint64_t{0} >> (64 - VariableSize));
+        const auto *member_words = &this->words[first_word(member, 0)];
+        for (size_t group = 0; group < NumberOfVariables; group++)
+        {
+            auto word = group * VariableSize / bitops::word_bits;
+            const auto *low = member_words + word * this->lanes;
+            // The next word is only read by groups that straddle two words.
+            const auto *high = word + 1 < word_count ? low + this->lanes : low;
+            auto values = out.row(group).subspan(column, this->lanes);
+            for (size_t lane = 0; lane < this->lanes; lane++)
+            {
+                values[lane] = min + (max - min) * ((double)group_bits(low[lane], high[lane], group) / full);
+            }
+        }
+    }
+
+    /**
+     * @brief Decode one lane of a member into one column of a matrix.
+     */
+    void decode(size_t member, size_t lane, double min, double max, DecodedPopulation &out, size_t column) const
+    {
+        constexpr double full = (double)(~uint64_t{0} >> (64 - VariableSize));
+        auto genome_of = genome(member, lane);
+        for (size_t group = 0; group < NumberOfVariables; group++)
+        {
+            auto word = group * VariableSize / bitops::word_bits;
+            auto high = word + 1 < word_count ? genome_of.word(word + 1) : 0;
+            out(group, column) = min + (max - min) * ((double)group_bits(genome_of.word(word), high, group) / full);
+        }
+    }
+};
+
+/**
+ * StaticSimpleGA for several runs at once, in lockstep.
+ * All lanes share one LanePopulation. Decoding and evaluation of a
+ * deterministic objective run across lanes: the stale members of a block
+ * are decoded with their lanes side by side and the whole block goes to
+ * the batch kernel in one call. The generation statistics also loop over
+ * runs innermost. Since a kernel gives a member the same bits at any
+ * column, and selection, crossover and mutation draw from each lane's own
+ * streams in StaticSimpleGA's order, every lane reproduces the series of
+ * the corresponding single run exactly. The engine has no stopping
+ * criteria, cache, executor or generation hook.
+ */
+template <typename Function, size_t VariableSize, size_t NumberOfVariables>
+class LockstepSimpleGA : public LockstepAlgorithm
+{
+    static_assert(std::is_base_of_v<OptimizationFunction, Function>);
+    static_assert(std::is_final_v<Function>, "Calls only devirtualize on a final function type");
+
+    using Lanes = LanePopulation<VariableSize, NumberOfVariables>;
+
+public:
+    LockstepSimpleGA(
+        size_t pop_size,
+        size_t num_of_gens,
+        double crossover_p,
+        double mutation_p,
+        Function &func,
+        size_t runs,
+        SelectionStrategy selection_strategy = SelectionStrategy::proportional,
+        size_t tournament_size = 2) : LockstepAlgorithm(runs),
+                                      population_size(pop_size),
+                                      num_of_generations(num_of_gens),
+                                      crossover_prob(crossover_p),
+                                      mutation(mutation_p),
+                                      objective(func),
+                                      min(func.getXRange().first),
+                                      max(func.getXRange().second),
+                                      max_y(func.getMaxY()),
+                                      selections(runs, Selection(selection_strategy, tournament_size))
+    {
+        assert(pop_size > 0);
+        assert(num_of_gens > 0);
+        assert(crossover_p >= 0.0 && crossover_p <= 1.0);
+        assert(func.getNumberOfVariables() == NumberOfVariables);
+    }
+
+    std::vector<std::vector<GenerationPerformance>> run() override
+    {
+        this->evaluation_batches = 0;
+        // The solution vectors of every record are allocated up front.
+        std::vector<std::vector<GenerationPerformance>> performance(lanes, std::vector<GenerationPerformance>(num_of_generations));
+        for (auto &series : performance)
+        {
+            for (auto &record : series)
+            {
+                record.best_solution.resize(NumberOfVariables);
+                record.worst_solution.resize(NumberOfVariables);
+            }
+        }
+        Lanes population(population_size, lanes), new_population(population_size, lanes);
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            for (size_t i = 0; i < population_size; i++)
+            {
+                seat(lane, rng::Phase::initialization, 0, i);
+                population.randomize(i, lane);
+            }
+        }
+        lane_fitness.resize(lanes * population_size);
+
+        for (size_t generation = 0; generation < num_of_generations; generation++)
+        {
+            evaluate(population);
+            record(generation, population, performance);
+
+            // Lanes breed independently, split across threads.
+            parallel::for_each_chunk(lanes, threads, [&](size_t begin, size_t end, size_t)
+                                     {
+                for (size_t lane = begin; lane < end; lane++)
+                {
+                    breed(lane, generation, population, new_population);
+                } });
+            std::swap(population, new_population);
+        }
+        return performance;
+    }
+
+private:
+    size_t population_size;
+    size_t num_of_generations;
+    double crossover_prob;
+    GeometricMutation mutation;
+    Function &objective;
+    double min, max, max_y;
+    std::vector<Selection> selections;
+    // The fitness of lane l at [l * population_size, (l + 1) * population_size), for its selection.
+    std::vector<double> lane_fitness;
+    // Members with at least one stale lane, see evaluate().
+    std::vector<size_t> stale;
+    // One decoded block and its objective function values per thread.
+    std::vector<DecodedPopulation> decoded;
+    std::vector<std::vector<double>> values;
+    // One decoded best or worst member of a lane, see record().
+    DecodedPopulation solution{NumberOfVariables, 1};
+    // Per-lane accumulators of record().
+    std::vector<size_t> best, worst;
+    std::vector<double> fitness_sum, objective_sum, block_fitness, block_objective;
+    PopulationFingerprint fingerprint;
+    uint64_t evaluation_batches = 0;
+
+    void set_result(Lanes &population, size_t index, double value) const
+    {
+        population.objective[index] = value;
+        population.fitness[index] = max_y - value;
+        population.evaluated[index] = true;
+        assert(population.fitness[index] >= 0.0);
+    }
+
+    /**
+     * @brief Evaluate every lane of every member that needs it.
+     * For deterministic objectives, members whose lanes are all evaluated
+     * are skipped. The rest are split into blocks of about
+     * Algorithm::block_size columns. All lanes of a member are decoded side
+     * by side and the block is evaluated in one batch call. Lanes that were
+     * still evaluated get the same value again, since a kernel's result
+     * does not depend on the column. A noisy objective draws every lane's
+     * noise from that run's own evaluation streams, which one batch call
+     * cannot seat for several runs. So it is evaluated one lane at a time,
+     * in the same blocks of members as a single run.
+     */
+    void evaluate(Lanes &population)
+    {
+        auto batch = this->evaluation_batches++;
+        decoded.resize(threads);
+        values.resize(threads);
+        if (!objective.isDeterministic())
+        {
+            auto blocks = (population_size + Algorithm::block_size - 1) / Algorithm::block_size;
+            parallel::for_each_chunk(lanes * blocks, threads, [&](size_t begin, size_t end, size_t chunk)
+                                     {
+                auto &x = decoded[chunk];
+                for (size_t unit = begin; unit < end; unit++)
+                {
+                    auto lane = unit / blocks;
+                    auto first = unit % blocks * Algorithm::block_size;
+                    auto last = std::min(population_size, first + Algorithm::block_size);
+                    x.resize(NumberOfVariables, last - first);
+                    for (size_t i = first; i < last; i++)
+                    {
+                        population.decode(i, lane, min, max, x, i - first);
+                    }
+                    auto &block_values = values[chunk];
+                    block_values.resize(last - first);
+                    seat(lane, rng::Phase::evaluation, batch, first);
+                    objective.evalBatch(x, block_values);
+                    for (size_t i = first; i < last; i++)
+                    {
+                        set_result(population, population.at(i, lane), block_values[i - first]);
+                    }
+                } });
+            return;
+        }
+        stale.clear();
+        for (size_t i = 0; i < population_size; i++)
+        {
+            auto lane_flags = std::span(population.evaluated).subspan(population.at(i, 0), lanes);
+            if (!std::ranges::all_of(lane_flags, std::identity{}))
+            {
+                stale.push_back(i);
+            }
+        }
+        auto members_per_block = std::max<size_t>(1, Algorithm::block_size / lanes);
+        parallel::for_each_block(stale.size(), members_per_block, threads, [&](size_t begin, size_t end, size_t chunk)
+                                 {
+            auto &x = decoded[chunk];
+            auto &block_values = values[chunk];
+            x.resize(NumberOfVariables, (end - begin) * lanes);
+            block_values.resize((end - begin) * lanes);
+            for (size_t k = begin; k < end; k++)
+            {
+                population.decode(stale[k], min, max, x, (k - begin) * lanes);
+            }
+            objective.evalBatch(x, block_values);
+            for (size_t k = begin; k < end; k++)
+            {
+                auto first = population.at(stale[k], 0);
+                for (size_t lane = 0; lane < lanes; lane++)
+                {
+                    set_result(population, first + lane, block_values[(k - begin) * lanes + lane]);
+                }
+            } });
+    }
+
+    /**
+     * @brief Write every lane's GenerationPerformance of a generation.
+     * Sums are accumulated per block of Algorithm::block_size members and
+     * the blocks added in order, and ties go to the lowest index, exactly
+     * as Algorithm::summarize does for a single run.
+     */
+    void record(size_t generation, const Lanes &population, std::vector<std::vector<GenerationPerformance>> &performance)
+    {
+        best.assign(lanes, 0);
+        worst.assign(lanes, 0);
+        fitness_sum.assign(lanes, 0.0);
+        objective_sum.assign(lanes, 0.0);
+        block_fitness.resize(lanes);
+        block_objective.resize(lanes);
+        for (size_t begin = 0; begin < population_size; begin += Algorithm::block_size)
+        {
+            std::fill(block_fitness.begin(), block_fitness.end(), 0.0);
+            std::fill(block_objective.begin(), block_objective.end(), 0.0);
+            auto end = std::min(population_size, begin + Algorithm::block_size);
+            for (size_t i = begin; i < end; i++)
+            {
+                const auto *fitness = &population.fitness[population.at(i, 0)];
+                const auto *objective_values = &population.objective[population.at(i, 0)];
+                for (size_t lane = 0; lane < lanes; lane++)
+                {
+                    block_fitness[lane] += fitness[lane];
+                    block_objective[lane] += objective_values[lane];
+                    best[lane] = fitness[lane] > population.fitness[population.at(best[lane], lane)] ? i : best[lane];
+                    worst[lane] = fitness[lane] < population.fitness[population.at(worst[lane], lane)] ? i : worst[lane];
+                }
+            }
+            for (size_t lane = 0; lane < lanes; lane++)
+            {
+                fitness_sum[lane] = begin == 0 ? block_fitness[lane] : fitness_sum[lane] + block_fitness[lane];
+                objective_sum[lane] = begin == 0 ? block_objective[lane] : objective_sum[lane] + block_objective[lane];
+            }
+        }
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            auto b = population.at(best[lane], lane), w = population.at(worst[lane], lane);
+            auto &record = performance[lane][generation];
+            record.generation = generation;
+            record.best_fitness = population.fitness[b];
+            record.average_fitness = fitness_sum[lane] / (double)population_size;
+            record.worst_fitness = population.fitness[w];
+            record.best_objective_function_value = population.objective[b];
+            record.average_objective_function_value = objective_sum[lane] / (double)population_size;
+            record.worst_objective_function_value = population.objective[w];
+            decode(population, best[lane], lane, record.best_solution);
+            decode(population, worst[lane], lane, record.worst_solution);
+            record.distinct_individuals = fingerprint.count_distinct(typename Lanes::Lane{&population, lane}, std::identity{});
+        }
+    }
+
+    void decode(const Lanes &population, size_t member, size_t lane, std::span<double> out)
+    {
+        population.decode(member, lane, min, max, solution, 0);
+        solution.gather(0, out);
+    }
+
+    /**
+     * @brief Breed the next generation of one lane, drawing as StaticSimpleGA::run does.
+     */
+    void breed(size_t lane, size_t generation, const Lanes &population, Lanes &new_population)
+    {
+        auto fitness = std::span(lane_fitness).subspan(lane * population_size, population_size);
+        for (size_t i = 0; i < population_size; i++)
+        {
+            fitness[i] = population.fitness[population.at(i, lane)];
+        }
+        auto &selection = selections[lane];
+        seat(lane, rng::Phase::selection, generation, 0);
+        selection.prepare(fitness);
+        for (size_t pair = 0; pair < (population_size + 1) / 2; pair++)
+        {
+            seat(lane, rng::Phase::breeding, generation, pair);
+            auto i = 2 * pair;
+            auto paired = i + 1 < population_size;
+            auto [first, second] = selection.select_pair(pair);
+            new_population.copy(i, population, first, lane);
+            if (paired)
+            {
+                new_population.copy(i + 1, population, second, lane);
+            }
+            auto &generator = get_generator();
+            if (generator.uniform() < crossover_prob)
+            {
+                auto point = generator.bounded(Lanes::bits);
+                if (paired)
+                {
+                    new_population.swap_tail(i, i + 1, lane, point);
+                    new_population.evaluated[new_population.at(i + 1, lane)] = false;
+                }
+                else
+                {
+                    // The second child of an odd population is dropped; its
+                    // mutation would be the pair's last draw, so it is skipped.
+                    new_population.copy_tail(i, population, second, lane, point);
+                }
+                new_population.evaluated[new_population.at(i, lane)] = false;
+            }
+            auto child1 = new_population.genome(i, lane);
+            if (mutation.apply(child1) > 0)
+            {
+                new_population.evaluated[new_population.at(i, lane)] = false;
+            }
+            if (paired)
+            {
+                auto child2 = new_population.genome(i + 1, lane);
+                if (mutation.apply(child2) > 0)
+                {
+                    new_population.evaluated[new_population.at(i + 1, lane)] = false;
+                }
+            }
+        }
+    }
+};
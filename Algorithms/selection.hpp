@@ -0,0 +1,231 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <span>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <utility>
+#include <cassert>
+
+#include "../random.hpp"
+
+/**
+ * The parent selection schemes available to SimpleGA.
+ */
+enum class SelectionStrategy
+{
+    // Fitness-proportional (roulette wheel) selection, O(1) per draw.
+    proportional,
+    // Stochastic universal sampling: the whole mating pool from one spin.
+    stochastic_universal,
+    // k-tournament: the fittest of k uniformly drawn individuals.
+    tournament
+};
+
+/**
+ * Parent selection for generational GAs.
+ * prepare() is called once per generation with the population's fitness and
+ * builds whatever the strategy needs (a Walker alias table for proportional
+ * selection, the whole shuffled mating pool for SUS), after which every draw
+ * is O(1) (O(k) for tournaments). All tables are reused between generations.
+ * Draws are const and only read the tables, so the threads breeding one
+ * generation can draw concurrently, each with its own generator.
+ */
+class Selection
+{
+private:
+    SelectionStrategy strategy;
+    size_t tournament_size;
+    std::span<const double> fitness;
+
+    // Alias table (proportional).
+    std::vector<double> probability;
+    std::vector<size_t> alias;
+    std::vector<size_t> small, large;
+
+    // Mating pool (stochastic universal sampling).
+    std::vector<size_t> pool;
+
+    void build_alias_table()
+    {
+        auto n = fitness.size();
+        probability.resize(n);
+        alias.resize(n);
+        small.reserve(n);
+        large.reserve(n);
+        double sum = std::accumulate(fitness.begin(), fitness.end(), 0.0);
+        if (!(sum > 0.0))
+        {
+            // No information in the fitness: select uniformly.
+            std::fill(probability.begin(), probability.end(), 1.0);
+            std::iota(alias.begin(), alias.end(), 0);
+            return;
+        }
+        // Vose's method.
+        small.clear();
+        large.clear();
+        for (size_t i = 0; i < n; i++)
+        {
+            probability[i] = fitness[i] * (double)n / sum;
+            (probability[i] < 1.0 ? small : large).push_back(i);
+        }
+        while (!small.empty() && !large.empty())
+        {
+            auto s = small.back(), l = large.back();
+            small.pop_back();
+            alias[s] = l;
+            probability[l] -= 1.0 - probability[s];
+            if (probability[l] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Whatever is left is 1 up to rounding.
+        for (auto i : small)
+        {
+            probability[i] = 1.0;
+            alias[i] = i;
+        }
+        for (auto i : large)
+        {
+            probability[i] = 1.0;
+            alias[i] = i;
+        }
+    }
+
+    void build_mating_pool()
+    {
+        auto n = fitness.size();
+        pool.clear();
+        pool.reserve(n);
+        double sum = std::accumulate(fitness.begin(), fitness.end(), 0.0);
+        if (!(sum > 0.0))
+        {
+            pool.resize(n);
+            std::iota(pool.begin(), pool.end(), 0);
+        }
+        else
+        {
+            // n equally spaced pointers from one random offset.
+            auto spacing = sum / (double)n;
+            auto pointer = get_generator().uniform() * spacing;
+            double partial_sum = 0.0;
+            for (size_t i = 0; i < n && pool.size() < n; i++)
+            {
+                partial_sum += fitness[i];
+                while (pointer < partial_sum && pool.size() < n)
+                {
+                    pool.push_back(i);
+                    pointer += spacing;
+                }
+            }
+            // Rounding can leave the last pointer just past the total.
+            while (pool.size() < n)
+            {
+                pool.push_back(n - 1);
+            }
+        }
+        std::shuffle(pool.begin(), pool.end(), get_generator());
+    }
+
+    size_t draw_proportional(double uniform) const
+    {
+        auto u = uniform * (double)fitness.size();
+        auto i = std::min((size_t)u, fitness.size() - 1);
+        return u - (double)i < probability[i] ? i : alias[i];
+    }
+
+    size_t draw_from_pool(size_t slot) const
+    {
+        return pool[slot % pool.size()];
+    }
+
+    size_t draw_tournament() const
+    {
+        // The contestants come from bulk draws of up to one buffer each.
+        std::array<uint64_t, 16> contestants;
+        auto &generator = get_generator();
+        size_t winner = 0;
+        for (size_t drawn = 0; drawn < tournament_size; drawn += contestants.size())
+        {
+            auto count = std::min(contestants.size(), tournament_size - drawn);
+            generator.fill_bounded(std::span(contestants).first(count), fitness.size());
+            for (size_t k = 0; k < count; k++)
+            {
+                if ((drawn == 0 && k == 0) || fitness[contestants[k]] > fitness[winner])
+                {
+                    winner = contestants[k];
+                }
+            }
+        }
+        return winner;
+    }
+
+public:
+    explicit Selection(SelectionStrategy strategy = SelectionStrategy::proportional, size_t tournament_size = 2) : strategy(strategy),
+                                                                                                                   tournament_size(tournament_size)
+    {
+        assert(tournament_size > 0);
+    }
+
+    /**
+     * @brief Build the selection tables for a generation.
+     * @param generation_fitness The fitness of every individual. Must stay alive until the next prepare().
+     */
+    void prepare(std::span<const double> generation_fitness)
+    {
+        assert(!generation_fitness.empty());
+        fitness = generation_fitness;
+        switch (strategy)
+        {
+        case SelectionStrategy::proportional:
+            build_alias_table();
+            break;
+        case SelectionStrategy::stochastic_universal:
+            build_mating_pool();
+            break;
+        case SelectionStrategy::tournament:
+            break;
+        }
+    }
+
+    /**
+     * @brief Select one individual.
+     * @param slot The position in the mating pool being filled; SUS hands out pool[slot].
+     * @return The index of the selected individual.
+     */
+    size_t select(size_t slot) const
+    {
+        switch (strategy)
+        {
+        case SelectionStrategy::proportional:
+            return draw_proportional(get_generator().uniform());
+        case SelectionStrategy::stochastic_universal:
+            return draw_from_pool(slot);
+        case SelectionStrategy::tournament:
+            return draw_tournament();
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Select two parents, each with its own draw.
+     * Proportional selection takes both draws in one bulk draw.
+     * @param pair The index of the pair in the generation being bred.
+     * @return The indices of the two selected individuals.
+     */
+    std::pair<size_t, size_t> select_pair(size_t pair) const
+    {
+        if (strategy == SelectionStrategy::proportional)
+        {
+            std::array<double, 2> uniforms;
+            get_generator().fill_uniform(uniforms);
+            return std::make_pair(draw_proportional(uniforms[0]), draw_proportional(uniforms[1]));
+        }
+        auto first = select(2 * pair);
+        auto second = select(2 * pair + 1);
+        return std::make_pair(first, second);
+    }
+};
@@ -1,152 +1,143 @@
 #include "simple_ga.hpp"
 
-std::pair<size_t, size_t> SimpleGA::proportional_selection(std::vector<Individual> &population, std::vector<double> &fitness)
+void SimpleGA::crossover(const Population &parents, size_t first, size_t second, Population &children, size_t slot)
 {
-    std::uniform_real_distribution<double> distribution(0.0, 1.0);
-    double sum = std::accumulate(fitness.begin(), fitness.end(), 0.0);
-    double random = distribution(get_generator()) * sum;
-    size_t parent1_index = 0;
-    size_t parent2_index = population.size() - 1;
-    double partial_sum = 0.0;
-    for (size_t i = 0; i < population.size(); i++)
+    auto paired = slot + 1 < children.size();
+    children.copy(slot, parents, first);
+    if (paired)
     {
-        partial_sum += fitness[i];
-        if (partial_sum >= random)
-        {
-            parent1_index = i;
-            break;
-        }
+        children.copy(slot + 1, parents, second);
     }
-    partial_sum = 0.0;
-    for (size_t i = 0; i < population.size(); i++)
+    auto &generator = get_generator();
+    if (generator.uniform() < crossover_prob)
     {
-        partial_sum += fitness[i];
-        if (partial_sum >= random && i != parent1_index)
+        auto crossover_point = generator.bounded(variable_size * number_of_variables);
+        if (paired)
         {
-            parent2_index = i;
-            break;
+            children.swap_tail(slot, slot + 1, crossover_point);
+        }
+        else
+        {
+            children.copy_tail(slot, parents, second, crossover_point);
         }
     }
-    assert(parent1_index < population.size());
-    assert(parent2_index < population.size());
-    return std::make_pair(parent1_index, parent2_index);
 }
 
-std::pair<Individual, Individual> SimpleGA::crossover(Individual &parent1, Individual &parent2)
+void SimpleGA::mutate(Population &population, size_t index)
 {
-    std::uniform_int_distribution<size_t> distribution(0, variable_size * number_of_variables - 1);
-    auto crossover_point = distribution(get_generator());
-    Individual child1 = parent1;
-    Individual child2 = parent2;
-    for (size_t i = crossover_point; i < variable_size * number_of_variables; i++)
-    {
-        child1.setValueAt(i, parent2.getValueAt(i));
-        child2.setValueAt(i, parent1.getValueAt(i));
-    }
-    return std::make_pair(child1, child2);
+    population.mutate(index, mutation);
 }
 
-void SimpleGA::mutate(Individual &individual)
+std::vector<GenerationPerformance> SimpleGA::run()
 {
-    std::uniform_real_distribution<double> distribution(0.0, 1.0);
-    for (size_t i = 0; i < variable_size * number_of_variables; i++)
+    start_run();
+    // The solution vectors of every record are allocated up front, so the
+    // generations only write into them.
+    std::vector<GenerationPerformance> performance(num_of_generations);
+    for (auto &record : performance)
     {
-        if (distribution(get_generator()) < mutation_prob)
-        {
-            individual.flip(i);
-        }
+        record.best_solution.resize(number_of_variables);
+        record.worst_solution.resize(number_of_variables);
     }
-}
-
-std::vector<GenerationPerformance> SimpleGA::run()
-{
-    std::vector<GenerationPerformance> performance;
-    performance.resize(num_of_generations);
-    std::vector<Individual> population;
-    population.reserve(population_size);
+    // Two buffers that swap roles every generation: children are written
+    // by index into the one not holding the parents, so the threads
+    // breeding different pairs never touch the same member, and once the
+    // first generation has grown the scratch buffers nothing is allocated.
+    Population population(GenomeSchema(variable_size, number_of_variables, function), population_size);
     for (size_t i = 0; i < population_size; i++)
     {
-        population.push_back(Individual(variable_size, number_of_variables, function));
+        seat(rng::Phase::initialization, 0, i);
+        population.randomize(i);
     }
+    prepare_terms(population);
+    Population new_population = population;
 
-    std::vector<double> generation_fitness(population_size);
-    std::vector<double> objective_function_values(population_size);
     for (size_t generation = 0; generation < num_of_generations; generation++)
     {
-        generation_fitness.clear();
-        objective_function_values.clear();
+#ifdef GA_COUNT_ALLOCATIONS
+        auto allocations = allocation_counter::count();
+#endif
         // Calculate fitness and objective function values.
-        for (Individual &individual : population)
-        {
-            individual.evaluate();
-            auto [fitness, objective_function_value] = individual.getFitness();
-            generation_fitness.push_back(fitness);
-            objective_function_values.push_back(objective_function_value);
-        }
+        evaluate(population);
 
         // Find best, average and worst fitness and objective function values.
-        auto it_of_best_fitness = std::max_element(generation_fitness.begin(), generation_fitness.end());
-        auto it_of_worst_fitness = std::min_element(generation_fitness.begin(), generation_fitness.end());
-
-        auto best_fitness = *it_of_best_fitness;
-        auto average_fitness = std::accumulate(generation_fitness.begin(), generation_fitness.end(), 0.0) / (double)population_size;
-        auto worst_fitness = *it_of_worst_fitness;
-        
-        auto index_of_best_x = (size_t)std::distance(generation_fitness.begin(), it_of_best_fitness);
-        auto index_of_worst_x = (size_t)std::distance(generation_fitness.begin(), it_of_worst_fitness);
-
-        auto best_objective_function_value = objective_function_values[index_of_best_x];
-        auto average_objective_function_value = std::accumulate(objective_function_values.begin(), objective_function_values.end(), 0.0) / (double)population_size;
-        auto worst_objective_function_value = objective_function_values[index_of_worst_x];
-
-        auto best_x = population[index_of_best_x].getVector().decode();
-        auto worst_x = population[index_of_worst_x].getVector().decode();
-
-        assert(best_x.size() == number_of_variables);
-        assert(worst_x.size() == number_of_variables);
-        performance[generation] = {
-            generation,
-            best_fitness,
-            average_fitness,
-            worst_fitness,
-            best_objective_function_value,
-            average_objective_function_value,
-            worst_objective_function_value,
-            best_x,
-            worst_x};
-
-        // Create new population.
-        std::vector<Individual> new_population;
-        new_population.reserve(population_size);
-        for (size_t i = 0; i < population_size - 1; i += 2)
+        auto summary = summarize(
+            population_size,
+            [&](size_t i)
+            { return population.fitness(i); },
+            [&](size_t i)
+            { return population.objective(i); });
+        auto &record = performance[generation];
+        record.generation = generation;
+        record.best_fitness = population.fitness(summary.best);
+        record.average_fitness = summary.fitness_sum / (double)population_size;
+        record.worst_fitness = population.fitness(summary.worst);
+        record.best_objective_function_value = population.objective(summary.best);
+        record.average_objective_function_value = summary.objective_sum / (double)population_size;
+        record.worst_objective_function_value = population.objective(summary.worst);
+        population.decode(summary.best, record.best_solution);
+        population.decode(summary.worst, record.worst_solution);
+        record.distinct_individuals = fingerprint.count_distinct(population, std::identity{});
+        if (should_stop(record) || !end_generation(record, population))
         {
-            // Select parents.
-            auto parents_indices = proportional_selection(population, generation_fitness);
-            auto parent1 = population[parents_indices.first];
-            auto parent2 = population[parents_indices.second];
-            auto child1 = parent1;
-            auto child2 = parent2;
+            performance.resize(generation + 1);
+            break;
+        }
 
-            // Crossover.
+        // Nothing is bred from the last generation.
+        if (generation + 1 == num_of_generations)
+        {
+            break;
+        }
 
-            auto distribution_of_chances = std::uniform_real_distribution<double>(0.0, 1.0);
-            if (distribution_of_chances(get_generator()) < crossover_prob)
+        // Create new population, one pair of children per pair of slots.
+        // An odd population keeps only the first child of the last pair.
+        seat(rng::Phase::selection, generation, 0);
+        selection.prepare(population.fitness());
+        auto breed = [&](size_t begin, size_t end, size_t)
+        {
+            for (size_t pair = begin; pair < end; pair++)
             {
-                auto children = crossover(parent1, parent2);
-                child1 = children.first;
-                child2 = children.second;
+                seat(rng::Phase::breeding, generation, pair);
+                // Select parents.
+                auto parents_indices = selection.select_pair(pair);
+
+                // Copy and cross the parents into the pair's slots.
+                crossover(population, parents_indices.first, parents_indices.second, new_population, 2 * pair);
+
+                // Mutate.
+                mutate(new_population, 2 * pair);
+                if (2 * pair + 1 < population_size)
+                {
+                    mutate(new_population, 2 * pair + 1);
+                }
             }
-
-            // Mutate.
-            mutate(child1);
-            mutate(child2);
-
-            // Add children to new population.
-            new_population.push_back(child1);
-            new_population.push_back(child2);
+        };
+        auto pairs = (population_size + 1) / 2;
+        if (pipelined())
+        {
+            // Hand each block of children to the executor as soon as it is
+            // bred; the next generation's evaluate() collects them.
+            for (size_t begin = 0; begin < pairs; begin += block_size / 2)
+            {
+                auto end = std::min(pairs, begin + block_size / 2);
+                breed(begin, end, 0);
+                submit_evaluation(new_population, 2 * begin, std::min(2 * end, population_size));
+            }
+        }
+        else
+        {
+            parallel::for_each_chunk(pairs, threads, breed);
+        }
+        std::swap(population, new_population);
+#ifdef GA_COUNT_ALLOCATIONS
+        if (generation > 0)
+        {
+            steady_state_allocations += allocation_counter::count() - allocations;
         }
-        population = new_population;
+#endif
     }
+    assert(steady_state_allocations == 0);
     return performance;
 }
 
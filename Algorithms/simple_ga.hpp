@@ -1,8 +1,9 @@
 #pragma once
 #include "algorithm.hpp"
+#include "selection.hpp"
 #include <array>
 
-extern std::mt19937 &get_generator();
+#include "../random.hpp"
 
 class SimpleGA : public Algorithm
 {
@@ -14,13 +15,16 @@ public:
         double mutation_p,
         size_t var_size,
         size_t num_of_variables,
-        OptimizationFunction &func) : Algorithm(pop_size,
+        OptimizationFunction &func,
+        SelectionStrategy selection_strategy = SelectionStrategy::proportional,
+        size_t tournament_size = 2) : Algorithm(pop_size,
                                                 num_of_gens,
                                                 crossover_p,
                                                 mutation_p,
                                                 var_size,
                                                 num_of_variables,
-                                                func)
+                                                func),
+                                      selection(selection_strategy, tournament_size)
     {
         check_initialization();
     }
@@ -29,29 +33,32 @@ public:
 
 private:
     /**
-     * @brief Select two individuals from a population using proportional selection.
-     *
-     * @param population The population.
-     * @param fitness The fitnesses of the population.
-     * @return std::pair<size_t, size_t>& The indices of the two selected individuals.
+     * @brief The parent selection scheme, prepared once per generation.
      */
-    std::pair<size_t, size_t> proportional_selection(std::vector<Individual> &population, std::vector<double> &fitness);
+    Selection selection;
 
     /**
-     * @brief One-point crossover two individuals.
+     * @brief Breed one pair of children from two parents.
+     * The children start as copies of their parents, evaluation included,
+     * and are one-point crossed over with probability crossover_prob.
      *
-     * @param parent1 The first parent.
-     * @param parent2 The second parent.
-     * @return std::pair<Individual, Individual> The two children.
+     * @param parents The current generation.
+     * @param first The index of the first parent.
+     * @param second The index of the second parent.
+     * @param children The next generation.
+     * @param slot The index of the first child. The second child goes to
+     * slot + 1, or is dropped if that is past the end of children.
      */
-    std::pair<Individual, Individual> crossover(Individual &parent1, Individual &parent2);
+    void crossover(const Population &parents, size_t first, size_t second, Population &children, size_t slot);
 
     /**
-     * @brief Bit-flip mutate an individual.
+     * @brief Bit-flip mutate a member.
+     * Only the flipped positions are drawn, see GeometricMutation.
      *
-     * @param individual The individual to mutate.
+     * @param population The population.
+     * @param index The member to mutate.
      */
-    void mutate(Individual &individual);
+    void mutate(Population &population, size_t index);
 
     /**
      * @brief Debug assertions to check if initializations are correct.
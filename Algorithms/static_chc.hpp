@@ -0,0 +1,156 @@
+#pragma once
+#include "static_engine.hpp"
+#include "chc_operators.hpp"
+
+/**
+ * CHC specialized at compile time on the objective and genome geometry.
+ * Same scheme as CHC: random pairing, HUX crossover with incest prevention,
+ * elitist survivor selection and cataclysmic restart on convergence.
+ */
+template <typename Function, size_t VariableSize, size_t NumberOfVariables>
+class StaticCHC : public StaticEngine<Function, VariableSize, NumberOfVariables>
+{
+    using Base = StaticEngine<Function, VariableSize, NumberOfVariables>;
+    using typename Base::Genome;
+    using typename Base::Member;
+    using typename Base::Members;
+
+public:
+    StaticCHC(
+        size_t pop_size,
+        size_t num_of_gens,
+        double crossover_p,
+        double mutation_p,
+        Function &func) : Base(pop_size, num_of_gens, crossover_p, mutation_p, func) {}
+
+    std::vector<GenerationPerformance> run() override
+    {
+        this->start_run();
+        auto performance = this->make_records();
+        Members population(this->population_size);
+        for (size_t i = 0; i < this->population_size; i++)
+        {
+            this->seat(rng::Phase::initialization, 0, i);
+            population[i].genome.randomize();
+        }
+        this->evaluate(population);
+
+        Members parents, children, survivors;
+        hux.resize(this->threads);
+        restart_flips.resize(this->threads);
+        for (size_t chunk = 0; chunk < this->threads; chunk++)
+        {
+            hux[chunk].reserve(Genome::bits);
+            restart_flips[chunk].reserve(Genome::bits);
+        }
+        this->fingerprint.reserve(this->population_size);
+        double difference_threshold = (double)Genome::bits / 4.0;
+        // Parents, children and survivors keep their size from the first
+        // generation on, so later generations copy into them without allocating.
+        for (size_t gen = 0; gen < this->num_of_generations; gen++)
+        {
+#ifdef GA_COUNT_ALLOCATIONS
+            auto allocations = allocation_counter::count();
+#endif
+            parents = population;
+            this->seat(rng::Phase::selection, gen, 0);
+            std::shuffle(parents.begin(), parents.end(), get_generator());
+            crossover(parents, children, difference_threshold, gen);
+            this->evaluate(children);
+            select_survivors(parents, children, survivors);
+            if (this->fingerprint.same_members(survivors, population, &Member::genome))
+            {
+                difference_threshold -= 1.;
+            }
+            std::swap(population, survivors);
+            if (difference_threshold < 0)
+            {
+                diverge(population, gen);
+                difference_threshold = this->mutation_prob * (1. - this->mutation_prob) * (double)this->population_size;
+            }
+            this->record(performance[gen], gen, population);
+            if (this->should_stop(performance[gen]))
+            {
+                performance.resize(gen + 1);
+                break;
+            }
+#ifdef GA_COUNT_ALLOCATIONS
+            if (gen > 0)
+            {
+                this->steady_state_allocations += allocation_counter::count() - allocations;
+            }
+#endif
+        }
+        assert(this->steady_state_allocations == 0);
+        return performance;
+    }
+
+private:
+    /**
+     * @brief HUX crossover of consecutive pairs of parents.
+     * Pairs closer than the threshold are passed through unchanged.
+     */
+    void crossover(const Members &recomb_parents, Members &children, double difference_threshold, size_t generation)
+    {
+        children = recomb_parents;
+        parallel::for_each_chunk(children.size() / 2, this->threads, [&](size_t begin, size_t end, size_t chunk)
+                                 {
+            for (size_t i = 2 * begin; i < 2 * end; i += 2)
+            {
+                this->seat(rng::Phase::breeding, generation, i / 2);
+                auto &child1 = children[i].genome;
+                auto &child2 = children[i + 1].genome;
+                if ((double)child1.hamming_distance(child2) / 2.0 > difference_threshold && hux[chunk].apply(child1, child2) > 0)
+                {
+                    children[i].evaluated = children[i + 1].evaluated = false;
+                }
+            } });
+    }
+
+    /**
+     * @brief Keep the best population_size of parents and children.
+     * On equal fitness children are preferred, as in CHC::select_survivors.
+     */
+    void select_survivors(const Members &parents, const Members &children, Members &survivors)
+    {
+        auto member = [&](size_t index) -> const Member &
+        {
+            return index < parents.size() ? parents[index] : children[index - parents.size()];
+        };
+        auto winners = elitist_selection.select(parents.size(), children.size(), this->population_size, [&](size_t index)
+                                                { return member(index).fitness; });
+        survivors.resize(this->population_size);
+        for (size_t i = 0; i < this->population_size; i++)
+        {
+            survivors[i] = member(winners[i].index);
+        }
+    }
+
+    /**
+     * @brief Cataclysmic restart: refill the population with mutated copies of the best member.
+     */
+    void diverge(Members &population, size_t generation)
+    {
+        auto best = *std::max_element(population.begin(), population.end(), [](const Member &a, const Member &b)
+                                      { return a.fitness < b.fitness; });
+        auto number_of_bit_flips = (size_t)std::round(this->mutation_prob * (double)Genome::bits);
+        parallel::for_each_chunk(population.size(), this->threads, [&](size_t begin, size_t end, size_t chunk)
+                                 {
+            for (size_t i = begin; i < end; i++)
+            {
+                population[i] = best;
+                if (i > 0)
+                {
+                    this->seat(rng::Phase::restart, generation, i);
+                    restart_flips[chunk].apply(population[i].genome, number_of_bit_flips);
+                    population[i].evaluated = number_of_bit_flips == 0;
+                }
+            } });
+        this->evaluate(population);
+    }
+
+    // One operator (and its scratch buffers) per thread.
+    std::vector<HUXCrossover> hux;
+    std::vector<RandomBitFlips> restart_flips;
+    ElitistSelection elitist_selection;
+};
@@ -0,0 +1,195 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+
+#include "algorithm.hpp"
+#include "../static_genome.hpp"
+
+/**
+ * Common base of the compile-time specialized engines.
+ * The objective is a concrete (final) function type and the genome geometry
+ * is fixed, so evaluation, decoding and the genetic operators are direct,
+ * inlinable calls with constant loop bounds instead of going through the
+ * OptimizationFunction vtable and runtime sizes.
+ * @tparam Function The concrete objective function type.
+ * @tparam VariableSize The number of bits per variable.
+ * @tparam NumberOfVariables The number of variables.
+ */
+template <typename Function, size_t VariableSize, size_t NumberOfVariables>
+class StaticEngine : public Algorithm
+{
+    static_assert(std::is_base_of_v<OptimizationFunction, Function>);
+    static_assert(std::is_final_v<Function>, "Calls only devirtualize on a final function type");
+
+public:
+    using Genome = StaticGenome<VariableSize, NumberOfVariables>;
+
+    /**
+     * A member of the population: the genome and its evaluation.
+     */
+    struct Member
+    {
+        Genome genome;
+        double fitness = 0.0;
+        double objective = 0.0;
+        // Whether fitness and objective belong to the current genome.
+        bool evaluated = false;
+    };
+
+    // A member holds its genome inline, so copying one is a flat copy and a
+    // population is one allocation, aligned to a cache line like a
+    // Population arena.
+    static_assert(std::is_trivially_copyable_v<Member>);
+
+    /**
+     * A population: all members in one contiguous, aligned block.
+     */
+    using Members = std::vector<Member, AlignedAllocator<Member>>;
+
+    StaticEngine(
+        size_t pop_size,
+        size_t num_of_gens,
+        double crossover_p,
+        double mutation_p,
+        Function &func) : Algorithm(pop_size, num_of_gens, crossover_p, mutation_p, VariableSize, NumberOfVariables, func),
+                          objective(func),
+                          min(func.getXRange().first),
+                          max(func.getXRange().second),
+                          max_y(func.getMaxY())
+    {
+        assert(func.getNumberOfVariables() == NumberOfVariables);
+    }
+
+protected:
+    Function &objective;
+    double min, max, max_y;
+
+    /**
+     * @brief Store a member's objective function value and the fitness derived from it.
+     */
+    void set_result(Member &member, double value) const
+    {
+        member.objective = value;
+        member.fitness = max_y - value;
+        member.evaluated = true;
+        assert(member.fitness >= 0.0);
+    }
+
+    /**
+     * @brief Evaluate a population in blocks, as Algorithm::evaluate does.
+     * Deterministic objectives skip members that are still evaluated and
+     * consult the cache; noisy ones evaluate all. Each block is decoded
+     * into its thread's reused matrix and passed to the objective's batch
+     * kernel, called directly on the final type, with the generator seated
+     * on the block's first member, so column j draws from the stream of the
+     * j-th member of the block.
+     */
+    void evaluate(Members &population)
+    {
+        auto deterministic = objective.isDeterministic();
+        this->pending.clear();
+        for (size_t i = 0; i < population.size(); i++)
+        {
+            if (!deterministic || !population[i].evaluated)
+            {
+                this->pending.push_back(i);
+            }
+        }
+        this->objective_values.resize(population.size());
+        this->decoded.resize(this->threads);
+        this->misses.resize(this->threads);
+        auto batch = this->evaluation_batches++;
+        auto genome_cache = deterministic ? this->cache.get() : nullptr;
+        std::atomic<uint64_t> evaluated = 0;
+        parallel::for_each_block(this->pending.size(), Algorithm::block_size, this->threads, [&](size_t begin, size_t end, size_t chunk)
+                                 {
+            this->seat(rng::Phase::evaluation, batch, this->pending[begin]);
+            auto &members = this->misses[chunk];
+            members.clear();
+            for (size_t k = begin; k < end; k++)
+            {
+                auto &member = population[this->pending[k]];
+                auto value = genome_cache ? genome_cache->find(member.genome) : std::nullopt;
+                if (value)
+                {
+                    set_result(member, *value);
+                }
+                else
+                {
+                    members.push_back(this->pending[k]);
+                }
+            }
+            if (members.empty())
+            {
+                return;
+            }
+            evaluated.fetch_add(members.size(), std::memory_order_relaxed);
+            auto values = std::span(this->objective_values).subspan(begin, members.size());
+            this->decoder.decode(members, this->decoded[chunk], [&](size_t i) -> const Genome &
+                                 { return population[i].genome; });
+            objective.evalBatch(this->decoded[chunk], values);
+            for (size_t j = 0; j < members.size(); j++)
+            {
+                auto &member = population[members[j]];
+                set_result(member, values[j]);
+                if (genome_cache)
+                {
+                    genome_cache->insert(member.genome, values[j]);
+                }
+            }
+        });
+        this->evaluation_count += evaluated.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Bit-flip mutate a genome.
+     * @return The number of flipped bits.
+     */
+    size_t mutate(Genome &genome) const
+    {
+        return mutation.apply(genome);
+    }
+
+    /**
+     * @brief Create the records of a run.
+     * Their solution vectors are allocated up front, so the generations
+     * only write into them.
+     */
+    std::vector<GenerationPerformance> make_records() const
+    {
+        std::vector<GenerationPerformance> performance(this->num_of_generations);
+        for (auto &performance_record : performance)
+        {
+            performance_record.best_solution.resize(NumberOfVariables);
+            performance_record.worst_solution.resize(NumberOfVariables);
+        }
+        return performance;
+    }
+
+    /**
+     * @brief Summarize an evaluated population into a record from make_records().
+     */
+    void record(GenerationPerformance &performance, size_t generation, const Members &population)
+    {
+        auto summary = summarize(
+            population.size(),
+            [&](size_t i)
+            { return population[i].fitness; },
+            [&](size_t i)
+            { return population[i].objective; });
+        const auto &best = population[summary.best];
+        const auto &worst = population[summary.worst];
+        performance.generation = generation;
+        performance.best_fitness = best.fitness;
+        performance.average_fitness = summary.fitness_sum / (double)population.size();
+        performance.worst_fitness = worst.fitness;
+        performance.best_objective_function_value = best.objective;
+        performance.average_objective_function_value = summary.objective_sum / (double)population.size();
+        performance.worst_objective_function_value = worst.objective;
+        std::ranges::copy(best.genome.decode(min, max), performance.best_solution.begin());
+        std::ranges::copy(worst.genome.decode(min, max), performance.worst_solution.begin());
+        performance.distinct_individuals = fingerprint.count_distinct(population, &Member::genome);
+    }
+};
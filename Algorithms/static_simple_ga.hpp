@@ -0,0 +1,102 @@
+#pragma once
+#include "static_engine.hpp"
+#include "selection.hpp"
+
+/**
+ * SimpleGA specialized at compile time on the objective and genome geometry.
+ * Same operators as SimpleGA: the configured parent selection, one-point
+ * crossover and bit-flip mutation.
+ */
+template <typename Function, size_t VariableSize, size_t NumberOfVariables>
+class StaticSimpleGA : public StaticEngine<Function, VariableSize, NumberOfVariables>
+{
+    using Base = StaticEngine<Function, VariableSize, NumberOfVariables>;
+    using typename Base::Genome;
+    using typename Base::Member;
+    using typename Base::Members;
+
+public:
+    StaticSimpleGA(
+        size_t pop_size,
+        size_t num_of_gens,
+        double crossover_p,
+        double mutation_p,
+        Function &func,
+        SelectionStrategy selection_strategy = SelectionStrategy::proportional,
+        size_t tournament_size = 2) : Base(pop_size, num_of_gens, crossover_p, mutation_p, func),
+                                      selection(selection_strategy, tournament_size) {}
+
+    std::vector<GenerationPerformance> run() override
+    {
+        this->start_run();
+        auto performance = this->make_records();
+        // As in SimpleGA, two populations swap roles every generation, so
+        // once the first generation has grown the scratch buffers nothing
+        // is allocated.
+        Members population(this->population_size);
+        Members new_population(this->population_size);
+        std::vector<double> fitness(this->population_size);
+        for (size_t i = 0; i < this->population_size; i++)
+        {
+            this->seat(rng::Phase::initialization, 0, i);
+            population[i].genome.randomize();
+        }
+
+        for (size_t generation = 0; generation < this->num_of_generations; generation++)
+        {
+#ifdef GA_COUNT_ALLOCATIONS
+            auto allocations = allocation_counter::count();
+#endif
+            this->evaluate(population);
+            this->record(performance[generation], generation, population);
+            if (this->should_stop(performance[generation]))
+            {
+                performance.resize(generation + 1);
+                break;
+            }
+            std::transform(population.begin(), population.end(), fitness.begin(), [](const Member &member)
+                           { return member.fitness; });
+
+            // Breed the next generation in place of the previous one, pairs split across threads.
+            this->seat(rng::Phase::selection, generation, 0);
+            selection.prepare(fitness);
+            parallel::for_each_chunk((this->population_size + 1) / 2, this->threads, [&](size_t begin, size_t end, size_t)
+                                     {
+                for (size_t pair = begin; pair < end; pair++)
+                {
+                    this->seat(rng::Phase::breeding, generation, pair);
+                    auto i = 2 * pair;
+                    auto [first, second] = selection.select_pair(pair);
+                    // Children start as copies of their parents, evaluation included,
+                    // and are only re-evaluated if crossover or mutation touched them.
+                    auto child1 = population[first];
+                    auto child2 = population[second];
+                    auto &generator = get_generator();
+                    if (generator.uniform() < this->crossover_prob)
+                    {
+                        child1.genome.swap_tail(child2.genome, generator.bounded(Genome::bits));
+                        child1.evaluated = child2.evaluated = false;
+                    }
+                    child1.evaluated = this->mutate(child1.genome) == 0 && child1.evaluated;
+                    child2.evaluated = this->mutate(child2.genome) == 0 && child2.evaluated;
+                    new_population[i] = child1;
+                    if (i + 1 < this->population_size)
+                    {
+                        new_population[i + 1] = child2;
+                    }
+                } });
+            std::swap(population, new_population);
+#ifdef GA_COUNT_ALLOCATIONS
+            if (generation > 0)
+            {
+                this->steady_state_allocations += allocation_counter::count() - allocations;
+            }
+#endif
+        }
+        assert(this->steady_state_allocations == 0);
+        return performance;
+    }
+
+private:
+    Selection selection;
+};
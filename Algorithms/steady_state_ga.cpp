@@ -0,0 +1,207 @@
+#include "steady_state_ga.hpp"
+
+SteadyStateGA::SteadyStateGA(
+    size_t pop_size,
+    size_t num_of_gens,
+    double crossover_p,
+    double mutation_p,
+    size_t var_size,
+    size_t num_of_variables,
+    OptimizationFunction &func,
+    size_t offspring,
+    ReplacementStrategy replacement_strategy,
+    SelectionStrategy selection_strategy,
+    size_t tournament_size) : Algorithm(pop_size, num_of_gens, crossover_p, mutation_p, var_size, num_of_variables, func),
+                              offspring_per_step(offspring),
+                              replacement(replacement_strategy),
+                              tournament_size(tournament_size),
+                              selection(selection_strategy, tournament_size)
+{
+    check_initialization();
+}
+
+void SteadyStateGA::breed(const Population &population, Population &children, size_t slot)
+{
+    auto &generator = get_generator();
+    for (size_t i = 0; i < children.size(); i += 2)
+    {
+        // Child slot + i takes pool position slot + i, so steps of any size walk the SUS pool in order.
+        auto first = selection.select(slot + i);
+        auto second = selection.select(slot + i + 1);
+        auto paired = i + 1 < children.size();
+        children.copy(i, population, first);
+        if (paired)
+        {
+            children.copy(i + 1, population, second);
+        }
+        if (generator.uniform() < crossover_prob)
+        {
+            auto crossover_point = generator.bounded(variable_size * number_of_variables);
+            if (paired)
+            {
+                children.swap_tail(i, i + 1, crossover_point);
+            }
+            else
+            {
+                children.copy_tail(i, population, second, crossover_point);
+            }
+        }
+        children.mutate(i, mutation);
+        if (paired)
+        {
+            children.mutate(i + 1, mutation);
+        }
+    }
+}
+
+size_t SteadyStateGA::choose_victim(const Population &population) const
+{
+    auto &generator = get_generator();
+    switch (replacement)
+    {
+    case ReplacementStrategy::worst:
+        return worst.top();
+    case ReplacementStrategy::random:
+        return generator.bounded(population_size);
+    case ReplacementStrategy::tournament_loser:
+    {
+        auto loser = generator.bounded(population_size);
+        for (size_t k = 1; k < tournament_size; k++)
+        {
+            auto challenger = generator.bounded(population_size);
+            if (population.fitness(challenger) < population.fitness(loser))
+            {
+                loser = challenger;
+            }
+        }
+        return loser;
+    }
+    }
+    return 0;
+}
+
+void SteadyStateGA::replace(Population &population, size_t victim, const Population &children, size_t child)
+{
+    fitness_sum += children.fitness(child) - population.fitness(victim);
+    objective_sum += children.objective(child) - population.objective(victim);
+    population.copy(victim, children, child);
+    best.update(victim, population.fitness(victim));
+    worst.update(victim, population.fitness(victim));
+}
+
+void SteadyStateGA::reset_statistics(const Population &population)
+{
+    best.reset(population.fitness());
+    worst.reset(population.fitness());
+    resum(population);
+}
+
+void SteadyStateGA::resum(const Population &population)
+{
+    fitness_sum = 0.0;
+    objective_sum = 0.0;
+    for (size_t i = 0; i < population_size; i++)
+    {
+        fitness_sum += population.fitness(i);
+        objective_sum += population.objective(i);
+    }
+}
+
+void SteadyStateGA::record(const Population &population, GenerationPerformance &performance)
+{
+    auto best_index = best.top(), worst_index = worst.top();
+    performance.best_fitness = population.fitness(best_index);
+    performance.average_fitness = fitness_sum / (double)population_size;
+    performance.worst_fitness = population.fitness(worst_index);
+    performance.best_objective_function_value = population.objective(best_index);
+    performance.average_objective_function_value = objective_sum / (double)population_size;
+    performance.worst_objective_function_value = population.objective(worst_index);
+    population.decode(best_index, performance.best_solution);
+    population.decode(worst_index, performance.worst_solution);
+    performance.distinct_individuals = fingerprint.count_distinct(population, std::identity{});
+}
+
+std::vector<GenerationPerformance> SteadyStateGA::run()
+{
+    start_run();
+    std::vector<GenerationPerformance> performance(num_of_generations);
+    for (size_t generation = 0; generation < num_of_generations; generation++)
+    {
+        performance[generation].generation = generation;
+        performance[generation].best_solution.resize(number_of_variables);
+        performance[generation].worst_solution.resize(number_of_variables);
+    }
+    GenomeSchema schema(variable_size, number_of_variables, function);
+    Population population(schema, population_size);
+    for (size_t i = 0; i < population_size; i++)
+    {
+        seat(rng::Phase::initialization, 0, i);
+        population.randomize(i);
+    }
+    prepare_terms(population);
+    evaluate(population);
+    reset_statistics(population);
+    record(population, performance[0]);
+    if (should_stop(performance[0]) || !end_generation(performance[0], population))
+    {
+        performance.resize(1);
+        return performance;
+    }
+
+    // One generation-equivalent is population_size offspring, bred a step at a time.
+    Population children(schema, offspring_per_step);
+    prepare_terms(children);
+    auto steps = (population_size + offspring_per_step - 1) / offspring_per_step;
+    for (size_t generation = 1; generation < num_of_generations; generation++)
+    {
+#ifdef GA_COUNT_ALLOCATIONS
+        auto allocations = allocation_counter::count();
+#endif
+        seat(rng::Phase::selection, generation, 0);
+        selection.prepare(population.fitness());
+        for (size_t step = 0; step < steps; step++)
+        {
+            seat(rng::Phase::breeding, generation, step);
+            breed(population, children, step * offspring_per_step);
+            evaluate(children);
+            // Victims are drawn from the step's stream after evaluation, which may reseat the generator.
+            seat(rng::Phase::breeding, generation, steps + step);
+            for (size_t child = 0; child < children.size(); child++)
+            {
+                replace(population, choose_victim(population), children, child);
+            }
+        }
+        // The running sums drift with every replacement; a generation-equivalent's worth is re-summed exactly.
+        resum(population);
+        record(population, performance[generation]);
+        if (should_stop(performance[generation]) || !end_generation(performance[generation], population))
+        {
+            performance.resize(generation + 1);
+            break;
+        }
+#ifdef GA_COUNT_ALLOCATIONS
+        if (generation > 1)
+        {
+            steady_state_allocations += allocation_counter::count() - allocations;
+        }
+#endif
+    }
+    assert(steady_state_allocations == 0);
+    return performance;
+}
+
+#ifndef NDEBUG
+void SteadyStateGA::check_initialization()
+{
+    assert(population_size > 0);
+    assert(num_of_generations > 0);
+    assert(crossover_prob >= 0.0 && crossover_prob <= 1.0);
+    assert(mutation_prob >= 0.0 && mutation_prob <= 1.0);
+    assert(variable_size > 0);
+    assert(number_of_variables > 0);
+    assert(offspring_per_step > 0 && offspring_per_step <= population_size);
+    assert(tournament_size > 0);
+}
+#else
+void SteadyStateGA::check_initialization() {}
+#endif
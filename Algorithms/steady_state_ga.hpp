@@ -0,0 +1,108 @@
+#pragma once
+#include "algorithm.hpp"
+#include "selection.hpp"
+#include "../indexed_heap.hpp"
+
+/**
+ * Which member of the population an offspring of SteadyStateGA replaces.
+ */
+enum class ReplacementStrategy
+{
+    // The least fit member.
+    worst,
+    // A uniformly drawn member.
+    random,
+    // The least fit of tournament_size uniformly drawn members.
+    tournament_loser
+};
+
+/**
+ * A steady-state sibling of SimpleGA: instead of breeding a whole new
+ * generation, every step breeds a few offspring with the same operators
+ * (the configured parent selection, one-point crossover, bit-flip
+ * mutation), evaluates them together and copies each over one member of
+ * the population, chosen by the replacement strategy. Nothing else is
+ * copied, and best and worst are maintained incrementally with indexed
+ * heaps. Totals are kept as running sums between records and summed anew
+ * once per generation-equivalent, so rounding does not accumulate over a
+ * long run.
+ *
+ * The series still has one record per generation: record 0 is the initial
+ * population and each further record follows population_size offspring
+ * (one generation-equivalent), so it fits the same CSV files as SimpleGA.
+ * Proportional and SUS selection tables are rebuilt once per
+ * generation-equivalent; tournaments always see the current population.
+ */
+class SteadyStateGA : public Algorithm
+{
+public:
+    /**
+     * @param offspring The number of offspring bred and evaluated per step.
+     * @param replacement_strategy Which member an offspring replaces.
+     * @param tournament_size The size of selection and replacement tournaments.
+     */
+    SteadyStateGA(
+        size_t pop_size,
+        size_t num_of_gens,
+        double crossover_p,
+        double mutation_p,
+        size_t var_size,
+        size_t num_of_variables,
+        OptimizationFunction &func,
+        size_t offspring = 2,
+        ReplacementStrategy replacement_strategy = ReplacementStrategy::worst,
+        SelectionStrategy selection_strategy = SelectionStrategy::tournament,
+        size_t tournament_size = 2);
+
+    std::vector<GenerationPerformance> run() override;
+
+private:
+    size_t offspring_per_step;
+    ReplacementStrategy replacement;
+    size_t tournament_size;
+    Selection selection;
+    // The highest and lowest fitness of the population.
+    IndexedHeap best{true}, worst{false};
+    double fitness_sum = 0.0;
+    double objective_sum = 0.0;
+
+    /**
+     * @brief Breed one step's offspring from the population.
+     * Pairs of parents are crossed over as in SimpleGA; an odd last pair
+     * keeps only its first child.
+     * @param population The population.
+     * @param children Receives the offspring, unevaluated where changed.
+     * @param slot The mating pool position of the step's first parent.
+     */
+    void breed(const Population &population, Population &children, size_t slot);
+
+    /**
+     * @brief Choose the member the next offspring replaces.
+     */
+    size_t choose_victim(const Population &population) const;
+
+    /**
+     * @brief Copy an evaluated offspring over a member and update the statistics.
+     */
+    void replace(Population &population, size_t victim, const Population &children, size_t child);
+
+    /**
+     * @brief Rebuild the heaps and sums from the whole population.
+     */
+    void reset_statistics(const Population &population);
+
+    /**
+     * @brief Recompute the fitness and objective sums from the whole population.
+     */
+    void resum(const Population &population);
+
+    /**
+     * @brief Write the record of a generation-equivalent from the maintained statistics.
+     */
+    void record(const Population &population, GenerationPerformance &performance);
+
+    /**
+     * @brief Debug assertions to check if initializations are correct.
+     */
+    void check_initialization();
+};
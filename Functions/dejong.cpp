@@ -24,7 +24,7 @@ double dejong::DeJong3::eval(std::span<double> X) const
                            { return acc + std::floor(x); });
 }
 
-double dejong::DeJong4::eval(std::span<double> X) const
+double dejong::DeJong4::evalNoiseFree(std::span<double> X) const
 {
     assert(X.size() == 10);
     double sum = 3.;
@@ -32,7 +32,12 @@ double dejong::DeJong4::eval(std::span<double> X) const
     {
         sum += (i + 1) * std::pow(*it, 4.);
     }
-    return sum + gauss();
+    return sum;
+}
+
+double dejong::DeJong4::eval(std::span<double> X) const
+{
+    return evalNoiseFree(X) + gauss(get_generator());
 }
 
 double dejong::DeJong5::eval(std::span<double> X) const
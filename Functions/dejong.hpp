@@ -2,6 +2,28 @@
 
 namespace dejong
 {
+    /**
+     * The instruction sets the batch kernels come in, narrowest first.
+     */
+    enum class KernelIsa
+    {
+        portable,
+        avx2,
+        avx512
+    };
+
+    /**
+     * @brief Get the widest kernels the CPU supports, which evalBatch uses by default.
+     */
+    KernelIsa supported_kernels();
+
+    /**
+     * @brief Make evalBatch use the kernels of one instruction set, e.g. to check each against eval().
+     * Not thread-safe; call it while no evaluation runs.
+     * @param isa The instruction set, at most supported_kernels().
+     */
+    void use_kernels(KernelIsa isa);
+
     /**
      * Spherical function
      * f(x) = sum_1^3(x_i^2)
@@ -9,15 +31,18 @@ namespace dejong
      * Minimum: f(0, 0, 0) = 0
      * Maximum: f(+-5.12, +-5.12, +-5.12) = 78.6432
      */
-    class DeJong1 : public OptimizationFunction
+    class DeJong1 final : public OptimizationFunction
     {
     public:
         double eval(std::span<double> X) const override;
+        void evalBatch(const DecodedPopulation &X, std::span<double> out) const override;
         const std::pair<double, double> getXRange() const override { return {-5.12, 5.12}; };
         const std::vector<double> getMinX() const override { return {0., 0., 0.}; };
         double getMinY() const override { return 0.; };
         double getMaxY() const override { return 78.6432; };
         size_t getNumberOfVariables() const override { return 3; };
+        bool isSeparable() const override { return true; }
+        double term(size_t variable, double x) const override { return x * x; }
     };
 
     /**
@@ -27,10 +52,11 @@ namespace dejong
      * Minimum: f(1, 1) = 0
      * Maximum: f(5.12, -5.12) = 98201.4
      */
-    class DeJong2 : public OptimizationFunction
+    class DeJong2 final : public OptimizationFunction
     {
     public:
         double eval(std::span<double> X) const override;
+        void evalBatch(const DecodedPopulation &X, std::span<double> out) const override;
         const std::pair<double, double> getXRange() const override { return {-5.12, 5.12}; };
         const std::vector<double> getMinX() const override { return {1., 1.}; };
         double getMinY() const override { return 0.; };
@@ -45,16 +71,20 @@ namespace dejong
      * Minimum: f(-5.12,-5.12, -5.12, -5.12, -5.12) = 0
      * Maximum: f(5.12, 5.12, 5.12, 5.12, 5.12) = 55
      */
-    class DeJong3 : public OptimizationFunction
+    class DeJong3 final : public OptimizationFunction
     {
 
     public:
         double eval(std::span<double> X) const override;
+        void evalBatch(const DecodedPopulation &X, std::span<double> out) const override;
         const std::pair<double, double> getXRange() const override { return {-5.12, 5.12}; };
         const std::vector<double> getMinX() const override { return {-5.12, -5.12, -5.12, -5.12, -5.12}; }
         double getMinY() const override { return 0.; }
         double getMaxY() const override { return 55.; }
         size_t getNumberOfVariables() const override { return 5; }
+        bool isSeparable() const override { return true; }
+        double term(size_t variable, double x) const override { return std::floor(x); }
+        double combineTerms(double sum) const override { return 30. + sum; }
     };
 
     /**
@@ -65,16 +95,21 @@ namespace dejong
      * Minimum: f(0, 0, 0, 0, 0, 0, 0, 0, 0, 0) = 0
      * Maximum: f(+-1.28, +-1.28, +-1.28, +-1.28, +-1.28, +-1.28, +-1.28, +-1.28, +-1.28, +-1.28) = 150.64
      */
-    class DeJong4 : public OptimizationFunction
+    class DeJong4 final : public OptimizationFunction
     {
-        double gauss() const
+        // A fresh distribution per draw, so the noise depends on the stream only.
+        static double gauss(rng::Stream &stream)
         {
-            static std::normal_distribution<> d(0, 1);
-            return d(get_generator());
+            std::normal_distribution<> d(0, 1);
+            return d(stream);
         };
 
+        // The quartic sum without the gaussian noise.
+        double evalNoiseFree(std::span<double> X) const;
+
     public:
         double eval(std::span<double> X) const override;
+        void evalBatch(const DecodedPopulation &X, std::span<double> out) const override;
         const std::pair<double, double> getXRange() const override { return {-1.28, 1.28}; }
         const std::vector<double> getMinX() const override
         {
@@ -83,6 +118,10 @@ namespace dejong
         double getMinY() const override { return 0.; }
         double getMaxY() const override { return 150.64; }
         size_t getNumberOfVariables() const override { return 10; }
+        bool isDeterministic() const override { return false; }
+        bool isSeparable() const override { return true; }
+        double term(size_t variable, double x) const override { return (double)(variable + 1) * std::pow(x, 4.); }
+        double combineTerms(double sum) const override { return 3. + sum + gauss(get_generator()); }
     };
 
     /**
@@ -92,7 +131,7 @@ namespace dejong
      * Minimum: f(-32, -32) approx 1
      * Maximum: f(various, various) = 510
      */
-    class DeJong5 : public OptimizationFunction
+    class DeJong5 final : public OptimizationFunction
     {
         const std::array<std::array<double, 25>, 2> a = {{{
                                                               -32.,
@@ -151,6 +190,7 @@ namespace dejong
 
     public:
         double eval(std::span<double> X) const override;
+        void evalBatch(const DecodedPopulation &X, std::span<double> out) const override;
         const std::pair<double, double> getXRange() const override { return {-65.536, 65.536}; }
         const std::vector<double> getMinX() const override { return {-32., -32.}; }
         double getMinY() const override { return 1.; }
@@ -0,0 +1,435 @@
+#include "dejong.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DEJONG_X86_KERNELS 1
+#endif
+
+// Batch evaluation kernels for the De Jong functions.
+// Every function has a portable kernel and, on x86, hand-vectorized AVX2 and
+// AVX-512 kernels. The widest kernel the CPU supports is picked at runtime, so
+// the binary does not need to be built with -mavx*. The SIMD kernels handle
+// whole vectors and leave the remaining columns to the portable kernel.
+// Every kernel rounds each product and sum on its own, in the order eval()
+// does, so a column gets the same bits from every kernel and at every
+// position. AVX-512 implies FMA, which GCC would otherwise contract
+// multiply-adds into.
+#pragma GCC optimize("fp-contract=off")
+
+namespace
+{
+    using dejong::KernelIsa;
+
+    KernelIsa detect_isa()
+    {
+#ifdef DEJONG_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            return KernelIsa::avx512;
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return KernelIsa::avx2;
+        }
+#endif
+        return KernelIsa::portable;
+    }
+
+    // The kernels evalBatch runs; the widest supported unless use_kernels() chose others.
+    KernelIsa selected = detect_isa();
+
+#ifdef GA_CHECK_BATCH_KERNELS
+    /**
+     * @brief Check a batch kernel against the scalar evaluation of every column.
+     * @param X The decoded population.
+     * @param out The batch results.
+     * @param scalar The scalar evaluation to compare with.
+     */
+    template <typename Scalar>
+    void check_against_scalar(const DecodedPopulation &X, std::span<const double> out, Scalar scalar)
+    {
+        static thread_local std::vector<double> x;
+        x.resize(X.get_variables());
+        for (size_t i = 0; i < X.get_columns(); i++)
+        {
+            X.gather(i, x);
+            auto expected = scalar(std::span<double>(x));
+            assert(std::abs(out[i] - expected) <= 1e-9 * std::max(1.0, std::abs(expected)));
+        }
+    }
+#endif
+
+    // --------------------
+    // Portable kernels, starting at column begin.
+    // --------------------
+
+    void dejong1_portable(const DecodedPopulation &X, std::span<double> out, size_t begin)
+    {
+        auto x0 = X.row(0), x1 = X.row(1), x2 = X.row(2);
+        for (size_t i = begin; i < out.size(); i++)
+        {
+            out[i] = x0[i] * x0[i] + x1[i] * x1[i] + x2[i] * x2[i];
+        }
+    }
+
+    void dejong2_portable(const DecodedPopulation &X, std::span<double> out, size_t begin)
+    {
+        auto x0 = X.row(0), x1 = X.row(1);
+        for (size_t i = begin; i < out.size(); i++)
+        {
+            auto a = x0[i] * x0[i] - x1[i];
+            auto b = 1 - x0[i];
+            out[i] = 100 * a * a + b * b;
+        }
+    }
+
+    void dejong3_portable(const DecodedPopulation &X, std::span<double> out, size_t begin)
+    {
+        for (size_t i = begin; i < out.size(); i++)
+        {
+            out[i] = 30.;
+        }
+        for (size_t v = 0; v < X.get_variables(); v++)
+        {
+            auto x = X.row(v);
+            for (size_t i = begin; i < out.size(); i++)
+            {
+                out[i] += std::floor(x[i]);
+            }
+        }
+    }
+
+    void dejong4_portable(const DecodedPopulation &X, std::span<double> out, size_t begin)
+    {
+        for (size_t i = begin; i < out.size(); i++)
+        {
+            out[i] = 3.;
+        }
+        for (size_t v = 0; v < X.get_variables(); v++)
+        {
+            auto x = X.row(v);
+            auto weight = (double)(v + 1);
+            for (size_t i = begin; i < out.size(); i++)
+            {
+                auto x2 = x[i] * x[i];
+                out[i] += weight * (x2 * x2);
+            }
+        }
+    }
+
+    void dejong5_portable(const DecodedPopulation &X, std::span<double> out, size_t begin, const std::array<std::array<double, 25>, 2> &a)
+    {
+        auto x0 = X.row(0), x1 = X.row(1);
+        for (size_t i = begin; i < out.size(); i++)
+        {
+            double sum = 0.002;
+            for (size_t j = 0; j < 25; j++)
+            {
+                auto d0 = x0[i] - a[0][j];
+                auto d1 = x1[i] - a[1][j];
+                auto d0_2 = d0 * d0;
+                auto d1_2 = d1 * d1;
+                sum += 1. / ((double)j + 1. + d0_2 * d0_2 * d0_2 + d1_2 * d1_2 * d1_2);
+            }
+            out[i] = 1. / sum;
+        }
+    }
+
+#ifdef DEJONG_X86_KERNELS
+    // --------------------
+    // AVX2 kernels, 4 columns at a time. Return the first column not handled.
+    // --------------------
+
+    __attribute__((target("avx2"))) size_t dejong1_avx2(const DecodedPopulation &X, std::span<double> out)
+    {
+        const double *x0 = X.row(0).data(), *x1 = X.row(1).data(), *x2 = X.row(2).data();
+        size_t i = 0;
+        for (; i + 4 <= out.size(); i += 4)
+        {
+            auto a = _mm256_loadu_pd(x0 + i);
+            auto b = _mm256_loadu_pd(x1 + i);
+            auto c = _mm256_loadu_pd(x2 + i);
+            auto sum = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b)), _mm256_mul_pd(c, c));
+            _mm256_storeu_pd(out.data() + i, sum);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2"))) size_t dejong2_avx2(const DecodedPopulation &X, std::span<double> out)
+    {
+        const double *x0 = X.row(0).data(), *x1 = X.row(1).data();
+        const auto one = _mm256_set1_pd(1.), hundred = _mm256_set1_pd(100.);
+        size_t i = 0;
+        for (; i + 4 <= out.size(); i += 4)
+        {
+            auto a = _mm256_loadu_pd(x0 + i);
+            auto b = _mm256_loadu_pd(x1 + i);
+            auto t = _mm256_sub_pd(_mm256_mul_pd(a, a), b);
+            auto u = _mm256_sub_pd(one, a);
+            auto res = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(hundred, t), t), _mm256_mul_pd(u, u));
+            _mm256_storeu_pd(out.data() + i, res);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2"))) size_t dejong3_avx2(const DecodedPopulation &X, std::span<double> out)
+    {
+        size_t i = 0;
+        for (; i + 4 <= out.size(); i += 4)
+        {
+            auto sum = _mm256_set1_pd(30.);
+            for (size_t v = 0; v < X.get_variables(); v++)
+            {
+                sum = _mm256_add_pd(sum, _mm256_floor_pd(_mm256_loadu_pd(X.row(v).data() + i)));
+            }
+            _mm256_storeu_pd(out.data() + i, sum);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2"))) size_t dejong4_avx2(const DecodedPopulation &X, std::span<double> out)
+    {
+        size_t i = 0;
+        for (; i + 4 <= out.size(); i += 4)
+        {
+            auto sum = _mm256_set1_pd(3.);
+            for (size_t v = 0; v < X.get_variables(); v++)
+            {
+                auto x = _mm256_loadu_pd(X.row(v).data() + i);
+                auto x2 = _mm256_mul_pd(x, x);
+                sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_set1_pd((double)(v + 1)), _mm256_mul_pd(x2, x2)));
+            }
+            _mm256_storeu_pd(out.data() + i, sum);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2"))) size_t dejong5_avx2(const DecodedPopulation &X, std::span<double> out, const std::array<std::array<double, 25>, 2> &a)
+    {
+        const double *x0 = X.row(0).data(), *x1 = X.row(1).data();
+        const auto one = _mm256_set1_pd(1.);
+        size_t i = 0;
+        for (; i + 4 <= out.size(); i += 4)
+        {
+            auto p = _mm256_loadu_pd(x0 + i);
+            auto q = _mm256_loadu_pd(x1 + i);
+            auto sum = _mm256_set1_pd(0.002);
+            for (size_t j = 0; j < 25; j++)
+            {
+                auto d0 = _mm256_sub_pd(p, _mm256_set1_pd(a[0][j]));
+                auto d1 = _mm256_sub_pd(q, _mm256_set1_pd(a[1][j]));
+                auto d0_2 = _mm256_mul_pd(d0, d0);
+                auto d1_2 = _mm256_mul_pd(d1, d1);
+                auto d0_6 = _mm256_mul_pd(_mm256_mul_pd(d0_2, d0_2), d0_2);
+                auto d1_6 = _mm256_mul_pd(_mm256_mul_pd(d1_2, d1_2), d1_2);
+                auto denominator = _mm256_add_pd(_mm256_add_pd(_mm256_set1_pd((double)j + 1.), d0_6), d1_6);
+                sum = _mm256_add_pd(sum, _mm256_div_pd(one, denominator));
+            }
+            _mm256_storeu_pd(out.data() + i, _mm256_div_pd(one, sum));
+        }
+        return i;
+    }
+
+    // --------------------
+    // AVX-512 kernels, 8 columns at a time. Return the first column not handled.
+    // --------------------
+
+    __attribute__((target("avx512f"))) size_t dejong1_avx512(const DecodedPopulation &X, std::span<double> out)
+    {
+        const double *x0 = X.row(0).data(), *x1 = X.row(1).data(), *x2 = X.row(2).data();
+        size_t i = 0;
+        for (; i + 8 <= out.size(); i += 8)
+        {
+            auto a = _mm512_loadu_pd(x0 + i);
+            auto b = _mm512_loadu_pd(x1 + i);
+            auto c = _mm512_loadu_pd(x2 + i);
+            auto sum = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(a, a), _mm512_mul_pd(b, b)), _mm512_mul_pd(c, c));
+            _mm512_storeu_pd(out.data() + i, sum);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx512f"))) size_t dejong2_avx512(const DecodedPopulation &X, std::span<double> out)
+    {
+        const double *x0 = X.row(0).data(), *x1 = X.row(1).data();
+        const auto one = _mm512_set1_pd(1.), hundred = _mm512_set1_pd(100.);
+        size_t i = 0;
+        for (; i + 8 <= out.size(); i += 8)
+        {
+            auto a = _mm512_loadu_pd(x0 + i);
+            auto b = _mm512_loadu_pd(x1 + i);
+            auto t = _mm512_sub_pd(_mm512_mul_pd(a, a), b);
+            auto u = _mm512_sub_pd(one, a);
+            auto res = _mm512_add_pd(_mm512_mul_pd(_mm512_mul_pd(hundred, t), t), _mm512_mul_pd(u, u));
+            _mm512_storeu_pd(out.data() + i, res);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx512f"))) size_t dejong3_avx512(const DecodedPopulation &X, std::span<double> out)
+    {
+        size_t i = 0;
+        for (; i + 8 <= out.size(); i += 8)
+        {
+            auto sum = _mm512_set1_pd(30.);
+            for (size_t v = 0; v < X.get_variables(); v++)
+            {
+                auto x = _mm512_loadu_pd(X.row(v).data() + i);
+                sum = _mm512_add_pd(sum, _mm512_floor_pd(x));
+            }
+            _mm512_storeu_pd(out.data() + i, sum);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx512f"))) size_t dejong4_avx512(const DecodedPopulation &X, std::span<double> out)
+    {
+        size_t i = 0;
+        for (; i + 8 <= out.size(); i += 8)
+        {
+            auto sum = _mm512_set1_pd(3.);
+            for (size_t v = 0; v < X.get_variables(); v++)
+            {
+                auto x = _mm512_loadu_pd(X.row(v).data() + i);
+                auto x2 = _mm512_mul_pd(x, x);
+                sum = _mm512_add_pd(sum, _mm512_mul_pd(_mm512_set1_pd((double)(v + 1)), _mm512_mul_pd(x2, x2)));
+            }
+            _mm512_storeu_pd(out.data() + i, sum);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx512f"))) size_t dejong5_avx512(const DecodedPopulation &X, std::span<double> out, const std::array<std::array<double, 25>, 2> &a)
+    {
+        const double *x0 = X.row(0).data(), *x1 = X.row(1).data();
+        const auto one = _mm512_set1_pd(1.);
+        size_t i = 0;
+        for (; i + 8 <= out.size(); i += 8)
+        {
+            auto p = _mm512_loadu_pd(x0 + i);
+            auto q = _mm512_loadu_pd(x1 + i);
+            auto sum = _mm512_set1_pd(0.002);
+            for (size_t j = 0; j < 25; j++)
+            {
+                auto d0 = _mm512_sub_pd(p, _mm512_set1_pd(a[0][j]));
+                auto d1 = _mm512_sub_pd(q, _mm512_set1_pd(a[1][j]));
+                auto d0_2 = _mm512_mul_pd(d0, d0);
+                auto d1_2 = _mm512_mul_pd(d1, d1);
+                auto d0_6 = _mm512_mul_pd(_mm512_mul_pd(d0_2, d0_2), d0_2);
+                auto d1_6 = _mm512_mul_pd(_mm512_mul_pd(d1_2, d1_2), d1_2);
+                auto denominator = _mm512_add_pd(_mm512_add_pd(_mm512_set1_pd((double)j + 1.), d0_6), d1_6);
+                sum = _mm512_add_pd(sum, _mm512_div_pd(one, denominator));
+            }
+            _mm512_storeu_pd(out.data() + i, _mm512_div_pd(one, sum));
+        }
+        return i;
+    }
+#endif
+
+    /**
+     * @brief Run the widest available kernel, then the portable kernel on the rest.
+     */
+    template <typename Avx512, typename Avx2, typename Portable>
+    void dispatch(Avx512 avx512, Avx2 avx2, Portable portable)
+    {
+        size_t done = 0;
+#ifdef DEJONG_X86_KERNELS
+        switch (selected)
+        {
+        case KernelIsa::avx512:
+            done = avx512();
+            break;
+        case KernelIsa::avx2:
+            done = avx2();
+            break;
+        case KernelIsa::portable:
+            break;
+        }
+#else
+        (void)avx512;
+        (void)avx2;
+#endif
+        portable(done);
+    }
+}
+
+dejong::KernelIsa dejong::supported_kernels()
+{
+    static const KernelIsa supported = detect_isa();
+    return supported;
+}
+
+void dejong::use_kernels(KernelIsa isa)
+{
+    assert(isa <= supported_kernels());
+    selected = isa;
+}
+
+#ifdef DEJONG_X86_KERNELS
+#define DEJONG_KERNEL(name, ...) [&] { return name(__VA_ARGS__); }
+#else
+#define DEJONG_KERNEL(name, ...) [] { return size_t{0}; }
+#endif
+
+void dejong::DeJong1::evalBatch(const DecodedPopulation &X, std::span<double> out) const
+{
+    assert(X.get_variables() == 3 && out.size() == X.get_columns());
+    dispatch(DEJONG_KERNEL(dejong1_avx512, X, out), DEJONG_KERNEL(dejong1_avx2, X, out), [&](size_t begin)
+             { dejong1_portable(X, out, begin); });
+#ifdef GA_CHECK_BATCH_KERNELS
+    check_against_scalar(X, out, [this](std::span<double> x)
+                         { return eval(x); });
+#endif
+}
+
+void dejong::DeJong2::evalBatch(const DecodedPopulation &X, std::span<double> out) const
+{
+    assert(X.get_variables() == 2 && out.size() == X.get_columns());
+    dispatch(DEJONG_KERNEL(dejong2_avx512, X, out), DEJONG_KERNEL(dejong2_avx2, X, out), [&](size_t begin)
+             { dejong2_portable(X, out, begin); });
+#ifdef GA_CHECK_BATCH_KERNELS
+    check_against_scalar(X, out, [this](std::span<double> x)
+                         { return eval(x); });
+#endif
+}
+
+void dejong::DeJong3::evalBatch(const DecodedPopulation &X, std::span<double> out) const
+{
+    assert(X.get_variables() == 5 && out.size() == X.get_columns());
+    dispatch(DEJONG_KERNEL(dejong3_avx512, X, out), DEJONG_KERNEL(dejong3_avx2, X, out), [&](size_t begin)
+             { dejong3_portable(X, out, begin); });
+#ifdef GA_CHECK_BATCH_KERNELS
+    check_against_scalar(X, out, [this](std::span<double> x)
+                         { return eval(x); });
+#endif
+}
+
+void dejong::DeJong4::evalBatch(const DecodedPopulation &X, std::span<double> out) const
+{
+    assert(X.get_variables() == 10 && out.size() == X.get_columns());
+    dispatch(DEJONG_KERNEL(dejong4_avx512, X, out), DEJONG_KERNEL(dejong4_avx2, X, out), [&](size_t begin)
+             { dejong4_portable(X, out, begin); });
+#ifdef GA_CHECK_BATCH_KERNELS
+    check_against_scalar(X, out, [this](std::span<double> x)
+                         { return evalNoiseFree(x); });
+#endif
+    // Each column's noise comes from its own stream, as eval() would draw it.
+    auto stream = get_generator();
+    for (size_t i = 0; i < out.size(); i++)
+    {
+        auto column_stream = stream.sibling(i);
+        out[i] += gauss(column_stream);
+    }
+}
+
+void dejong::DeJong5::evalBatch(const DecodedPopulation &X, std::span<double> out) const
+{
+    assert(X.get_variables() == 2 && out.size() == X.get_columns());
+    dispatch(DEJONG_KERNEL(dejong5_avx512, X, out, a), DEJONG_KERNEL(dejong5_avx2, X, out, a), [&](size_t begin)
+             { dejong5_portable(X, out, begin, a); });
+#ifdef GA_CHECK_BATCH_KERNELS
+    check_against_scalar(X, out, [this](std::span<double> x)
+                         { return eval(x); });
+#endif
+}
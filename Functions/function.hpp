@@ -9,7 +9,8 @@
 #include <cassert>
 #include <initializer_list>
 
-extern std::mt19937& get_generator();
+#include "../batch_decode.hpp"
+#include "../random.hpp"
 
 /**
  * The OptimizationFunction class represents the function that we are trying to
@@ -25,6 +26,31 @@ public:
      */
     virtual double eval(const std::span<double> X) const = 0;
 
+    /**
+     * Evaluate a whole decoded population at once.
+     * The default evaluates one column at a time through eval(); functions
+     * override it with kernels that work on the rows directly.
+     * Random terms of column i are drawn from get_generator().sibling(i), the
+     * stream eval() would use if the generator were seated on that column.
+     * @param X The decoded population, one row per variable.
+     * @param out The objective function value of every column of X.
+     */
+    virtual void evalBatch(const DecodedPopulation &X, std::span<double> out) const
+    {
+        assert(out.size() == X.get_columns());
+        // Reused between calls, so batch evaluation does not allocate.
+        static thread_local std::vector<double> x;
+        x.resize(X.get_variables());
+        auto stream = get_generator();
+        for (size_t i = 0; i < X.get_columns(); i++)
+        {
+            X.gather(i, x);
+            get_generator() = stream.sibling(i);
+            out[i] = eval(x);
+        }
+        get_generator() = stream;
+    }
+
     /**
      * Get the domain of the function.
      * @return The domain of the function.
@@ -55,6 +81,42 @@ public:
      */
     virtual size_t getNumberOfVariables() const = 0;
 
+    /**
+     * Check if evaluating the same input always gives the same value.
+     * Only then may a value be reused for an unchanged or cached genome.
+     * @return False for noisy functions.
+     */
+    virtual bool isDeterministic() const { return true; }
+
+    /**
+     * Check if the function is a sum of independent per-variable terms,
+     * f(x) = combineTerms(term(0, x_0) + ... + term(n - 1, x_{n-1})).
+     * Separable functions can be re-evaluated after a change by recomputing
+     * only the terms of the variables that changed.
+     * @return True if term() and combineTerms() are implemented.
+     */
+    virtual bool isSeparable() const { return false; }
+
+    /**
+     * Get the contribution of one variable to a separable function.
+     * @param variable The index of the variable.
+     * @param x The value of the variable.
+     * @return The term of the variable.
+     */
+    virtual double term(size_t variable, double x) const
+    {
+        assert(false && "term() called on a function that is not separable");
+        return 0.0;
+    }
+
+    /**
+     * Turn the sum of the terms of a separable function into its value,
+     * adding any constant and, for noisy functions, the noise.
+     * @param sum The sum of the terms of all variables.
+     * @return The function value.
+     */
+    virtual double combineTerms(double sum) const { return sum; }
+
     /**
      * Convert a result to a fitness value.
      * @param solution The result to convert.
@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <thread>
+
+#include "function.hpp"
+
+/**
+ * A stand-in for an expensive objective: another function, with a fixed
+ * latency added to every evaluation.
+ * Values are exactly those of the wrapped function (batches go to its
+ * batch evaluation), so a run on the slow function reproduces the run on
+ * the fast one and only the timing changes. By default the latency is
+ * spent spinning, so it costs CPU time like a real objective; with
+ * spin false it is slept, like waiting for an objective computed elsewhere.
+ */
+class SlowFunction final : public OptimizationFunction
+{
+private:
+    OptimizationFunction &function;
+    std::chrono::nanoseconds latency;
+    bool spin;
+
+    void wait(size_t evaluations) const
+    {
+        auto duration = latency * (std::chrono::nanoseconds::rep)evaluations;
+        if (!spin)
+        {
+            std::this_thread::sleep_for(duration);
+            return;
+        }
+        auto until = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < until)
+        {
+        }
+    }
+
+public:
+    /**
+     * @param function The function computing the values.
+     * @param latency The time added to every evaluation.
+     * @param spin Whether to spend the latency spinning rather than sleeping.
+     */
+    SlowFunction(OptimizationFunction &function, std::chrono::nanoseconds latency, bool spin = true) : function(function),
+                                                                                                      latency(latency),
+                                                                                                      spin(spin) {}
+
+    double eval(std::span<double> X) const override
+    {
+        wait(1);
+        return function.eval(X);
+    }
+
+    void evalBatch(const DecodedPopulation &X, std::span<double> out) const override
+    {
+        wait(X.get_columns());
+        function.evalBatch(X, out);
+    }
+
+    const std::pair<double, double> getXRange() const override { return function.getXRange(); }
+    const std::vector<double> getMinX() const override { return function.getMinX(); }
+    double getMinY() const override { return function.getMinY(); }
+    double getMaxY() const override { return function.getMaxY(); }
+    size_t getNumberOfVariables() const override { return function.getNumberOfVariables(); }
+    bool isDeterministic() const override { return function.isDeterministic(); }
+};
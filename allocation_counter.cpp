@@ -0,0 +1,63 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.hpp"
+
+// Replacements of the global allocation functions that count every
+// allocation of the calling thread. The array and nothrow forms of the
+// standard library forward to these.
+
+namespace
+{
+    thread_local uint64_t allocations = 0;
+
+    void *allocate(std::size_t size, std::size_t alignment)
+    {
+        allocations++;
+        size = size == 0 ? 1 : size;
+        void *pointer = alignment <= alignof(std::max_align_t)
+                            ? std::malloc(size)
+                            : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (pointer == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+}
+
+uint64_t allocation_counter::count()
+{
+    return allocations;
+}
+
+void *operator new(std::size_t size)
+{
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, (std::size_t)alignment);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * Counts heap allocations, for checking that the generational loops do not
+ * allocate once their buffers have grown. Only available when built with
+ * GA_COUNT_ALLOCATIONS (cmake -DGA_COUNT_ALLOCATIONS=ON), which replaces
+ * the global operator new with a counting one (allocation_counter.cpp).
+ */
+namespace allocation_counter
+{
+    /**
+     * @brief Get the number of allocations made by the calling thread so far.
+     * Allocations of other threads, e.g. the workers of a parallel region,
+     * are not included.
+     */
+    uint64_t count();
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <ranges>
+#include <functional>
+#include <cassert>
+#include <cmath>
+
+#include "bitstring.hpp"
+
+/**
+ * A number_of_variables x population_size matrix of decoded values.
+ * Row v holds variable v of every individual (structure of arrays), so
+ * evaluation kernels can stream over one variable of the whole population.
+ * The storage is reused between generations and only grows.
+ */
+class DecodedPopulation
+{
+private:
+    std::vector<double> values;
+    size_t variables = 0;
+    size_t columns = 0;
+
+public:
+    DecodedPopulation() = default;
+    DecodedPopulation(size_t variables, size_t columns)
+    {
+        resize(variables, columns);
+    }
+
+    /**
+     * @brief Reshape the matrix. Does not allocate if it was ever this large before.
+     * @param variables The number of rows (variables).
+     * @param columns The number of columns (individuals).
+     */
+    void resize(size_t variables, size_t columns)
+    {
+        this->variables = variables;
+        this->columns = columns;
+        if (this->values.size() < variables * columns)
+        {
+            this->values.resize(variables * columns);
+        }
+    }
+
+    size_t get_variables() const { return this->variables; }
+    size_t get_columns() const { return this->columns; }
+
+    /**
+     * @brief Get every individual's value of one variable.
+     * @param variable The row to get.
+     */
+    std::span<double> row(size_t variable)
+    {
+        assert(variable < this->variables);
+        return std::span<double>(this->values).subspan(variable * this->columns, this->columns);
+    }
+    std::span<const double> row(size_t variable) const
+    {
+        assert(variable < this->variables);
+        return std::span<const double>(this->values).subspan(variable * this->columns, this->columns);
+    }
+
+    /**
+     * @brief Get the value of one variable of one individual.
+     */
+    double operator()(size_t variable, size_t column) const
+    {
+        assert(variable < this->variables && column < this->columns);
+        return this->values[variable * this->columns + column];
+    }
+    double &operator()(size_t variable, size_t column)
+    {
+        assert(variable < this->variables && column < this->columns);
+        return this->values[variable * this->columns + column];
+    }
+
+    /**
+     * @brief Copy all variables of one individual into a contiguous buffer.
+     * @param column The individual to copy.
+     * @param out The buffer, at least get_variables() long.
+     */
+    void gather(size_t column, std::span<double> out) const
+    {
+        assert(out.size() >= this->variables);
+        for (size_t v = 0; v < this->variables; v++)
+        {
+            out[v] = (*this)(v, column);
+        }
+    }
+};
+
+/**
+ * Decodes packed genomes into a DecodedPopulation.
+ * The scale factors of the encoding are computed once, and every group is
+ * read straight out of the packed words, so decoding a population does not
+ * allocate once the output matrix has reached its size.
+ */
+class BatchDecoder
+{
+private:
+    size_t group_size;
+    size_t groups;
+    double min;
+    double range;
+    double full;
+
+public:
+    BatchDecoder(size_t group_size, size_t groups, double min, double max) : group_size(group_size),
+                                                                             groups(groups),
+                                                                             min(min),
+                                                                             range(max - min),
+                                                                             full(std::ldexp(1.0, (int)group_size) - 1)
+    {
+        assert(group_size > 0 && group_size <= 64);
+        assert(groups > 0);
+        assert(min < max);
+    }
+
+    size_t get_group_size() const { return this->group_size; }
+    size_t get_groups() const { return this->groups; }
+
+    /**
+     * @brief Decode one group of a genome.
+     * Matches bitstring::decode exactly.
+     * @param words The packed words of the genome.
+     * @param group The group (variable) to decode.
+     */
+    double decode(std::span<const uint64_t> words, size_t group) const
+    {
+        auto val = bitops::extract(words, group * this->group_size, this->group_size);
+        return this->min + this->range * ((double)val / this->full);
+    }
+
+    /**
+     * @brief Decode all groups of a genome into one column of the matrix.
+     * @param words The packed words of the genome.
+     * @param out The matrix to write to.
+     * @param column The column to write.
+     */
+    void decode(std::span<const uint64_t> words, DecodedPopulation &out, size_t column) const
+    {
+        assert(out.get_variables() == this->groups);
+        assert(words.size() == bitops::words_for(this->group_size * this->groups));
+        for (size_t group = 0; group < this->groups; group++)
+        {
+            out(group, column) = decode(words, group);
+        }
+    }
+
+    /**
+     * @brief Decode a whole population.
+     * @param genomes The population, anything whose projection yields a genome.
+     * @param out The matrix to write to. Reshaped to groups x population size.
+     * @param projection Maps an element of the population to its genome (bitstring, StaticGenome or GenomeRef).
+     */
+    template <std::ranges::sized_range Genomes, typename Projection = std::identity>
+    void decode(const Genomes &genomes, DecodedPopulation &out, Projection projection = {}) const
+    {
+        out.resize(this->groups, std::ranges::size(genomes));
+        size_t column = 0;
+        for (const auto &genome : genomes)
+        {
+            decode(std::span<const uint64_t>(std::invoke(projection, genome).get_words()), out, column++);
+        }
+    }
+};
@@ -1,18 +1,145 @@
+#pragma once
 #include <vector>
 #include <numeric>
 #include <span>
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <iostream>
 #include <cassert>
 #include <cmath>
+#include <bit>
+#include <random>
+#include <functional>
 
-extern std::mt19937 &get_generator();
+#include "random.hpp"
 
-class bitstring : public std::vector<uint8_t>
+/**
+ * Word-level helpers shared by every packed genome representation.
+ * Bits are stored most-significant-first: bit i of a genome lives in word
+ * i / 64 at position 63 - i % 64, so a group of bits reads as an unsigned
+ * integer without any reordering. Unused bits of the last word are always 0.
+ */
+namespace bitops
+{
+    constexpr size_t word_bits = 64;
+
+    /**
+     * @brief Number of 64-bit words needed to store the given number of bits.
+     */
+    constexpr size_t words_for(size_t bits)
+    {
+        return (bits + word_bits - 1) / word_bits;
+    }
+
+    /**
+     * @brief Mask of the bit at the given index within its word.
+     */
+    constexpr uint64_t mask_of(size_t index)
+    {
+        return uint64_t{1} << (word_bits - 1 - index % word_bits);
+    }
+
+    /**
+     * @brief Mask of the bits of the last word that belong to a genome of the given length.
+     */
+    constexpr uint64_t tail_mask(size_t bits)
+    {
+        auto used = bits % word_bits;
+        return used == 0 ? ~uint64_t{0} : ~uint64_t{0} << (word_bits - used);
+    }
+
+    /**
+     * @brief Count the bits that differ between two equally sized word arrays.
+     */
+    inline size_t hamming_distance(std::span<const uint64_t> a, std::span<const uint64_t> b)
+    {
+        assert(a.size() == b.size());
+        size_t distance = 0;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            distance += (size_t)std::popcount(a[i] ^ b[i]);
+        }
+        return distance;
+    }
+
+    /**
+     * @brief Read len (1 to 64) bits starting at start as an unsigned integer.
+     */
+    inline uint64_t extract(std::span<const uint64_t> words, size_t start, size_t len)
+    {
+        assert(len > 0 && len <= word_bits);
+        auto word = start / word_bits;
+        auto offset = start % word_bits;
+        uint64_t value = words[word] << offset;
+        if (offset + len > word_bits)
+        {
+            value |= words[word + 1] >> (word_bits - offset);
+        }
+        return value >> (word_bits - len);
+    }
+
+    /**
+     * @brief Exchange every bit from point onwards between two equally sized word arrays.
+     * This is one-point crossover done a word at a time.
+     * @param a The first word array.
+     * @param b The second word array.
+     * @param point The index of the first bit to exchange.
+     */
+    inline void swap_tail(std::span<uint64_t> a, std::span<uint64_t> b, size_t point)
+    {
+        assert(a.size() == b.size());
+        auto word = point / word_bits;
+        if (word >= a.size())
+        {
+            return;
+        }
+        auto diff = (a[word] ^ b[word]) & (~uint64_t{0} >> (point % word_bits));
+        a[word] ^= diff;
+        b[word] ^= diff;
+        for (word++; word < a.size(); word++)
+        {
+            std::swap(a[word], b[word]);
+        }
+    }
+
+    /**
+     * @brief Mix a single word together with its position (splitmix64 finalizer).
+     */
+    constexpr uint64_t mix(uint64_t word, size_t position)
+    {
+        uint64_t z = word + 0x9E3779B97F4A7C15ull * (position + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Hash a word array.
+     * The hash is the XOR of every mixed word, so a change to one word can be
+     * applied to an existing hash by XORing out the old and in the new mix.
+     */
+    constexpr uint64_t hash(std::span<const uint64_t> words)
+    {
+        uint64_t h = 0;
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            h ^= mix(words[i], i);
+        }
+        return h;
+    }
+}
+
+class bitstring
 {
 private:
+    // The packed bits, most significant bit first.
+    std::vector<uint64_t> words;
+    // bitops::hash of the words, kept up to date by every modification.
+    uint64_t hash_value = 0;
+    // The number of bits in the bitstring.
+    size_t bits;
     // The minimum and maximum values that can be represented by the bitstring.
     double min, max;
     // The number of groups (variables) in the bitstring.
@@ -24,95 +151,155 @@ private:
      * 1. The size of the bitstring is divisible by the number of groups.
      * 2. The minimum value is less than the maximum value.
      * 3. The number of groups is greater than 0.
+     * 4. The padding bits of the last word are cleared.
      */
     void assertions() const
     {
-        assert(this->size() % this->groups == 0);
+        assert(this->bits % this->groups == 0);
         assert(this->min < this->max);
         assert(this->groups > 0);
-        assert(this->size() / this->groups <= 64);
+        assert(this->bits / this->groups <= 64);
+        assert(this->words.size() == bitops::words_for(this->bits));
+        assert(this->words.empty() || (this->words.back() & ~bitops::tail_mask(this->bits)) == 0);
+        assert(this->hash_value == bitops::hash(this->words));
     };
 
 public:
     // Constructors and destructors.
-    bitstring(std::vector<uint8_t> in_vector, double in_min, double in_max, size_t in_groups) : std::vector<uint8_t>(in_vector),
+    bitstring(std::vector<uint8_t> in_vector, double in_min, double in_max, size_t in_groups) : words(bitops::words_for(in_vector.size())),
+                                                                                                bits(in_vector.size()),
                                                                                                 min(in_min),
                                                                                                 max(in_max),
                                                                                                 groups(in_groups)
     {
+        this->hash_value = bitops::hash(this->words);
+        for (size_t i = 0; i < in_vector.size(); i++)
+        {
+            this->set(i, in_vector[i]);
+        }
         assertions();
     };
-    bitstring(size_t size_of_one_group, double in_min, double in_max, size_t in_groups) : std::vector<uint8_t>(size_of_one_group * in_groups),
-                                                                             min(in_min),
-                                                                             max(in_max),
-                                                                             groups(in_groups)
+    bitstring(size_t size_of_one_group, double in_min, double in_max, size_t in_groups) : words(bitops::words_for(size_of_one_group * in_groups)),
+                                                                                          bits(size_of_one_group * in_groups),
+                                                                                          min(in_min),
+                                                                                          max(in_max),
+                                                                                          groups(in_groups)
     {
+        this->hash_value = bitops::hash(this->words);
         assertions();
     };
 
     ~bitstring() = default;
 
-    bitstring(const bitstring &other) : std::vector<uint8_t>(other),
-                                        min(other.min),
-                                        max(other.max),
-                                        groups(other.groups)
-    {
-        assertions();
-    };
-    bitstring(bitstring &&other) : std::vector<uint8_t>(std::move(other)),
-                                   min(other.min),
-                                   max(other.max),
-                                   groups(other.groups)
+    bitstring(const bitstring &other) = default;
+    bitstring(bitstring &&other) = default;
+    bitstring &operator=(const bitstring &other) = default;
+    bitstring &operator=(bitstring &&other) = default;
+
+    // Overload the equality operator.
+    bool operator==(const bitstring &other) const
     {
-        assertions();
+        return this->hash_value == other.hash_value && this->min == other.min && this->max == other.max && this->groups == other.groups && this->bits == other.bits && this->words == other.words;
     };
 
-    bitstring &operator=(const bitstring &other)
+    // Overload the output operator.
+    friend std::ostream &operator<<(std::ostream &out, const bitstring &c)
     {
-        this->assign(other.begin(), other.end());
-        this->min = other.min;
-        this->max = other.max;
-        this->groups = other.groups;
-        assertions();
-        return *this;
+        for (size_t i = 0; i < c.size(); i++)
+        {
+            out << (c[i] ? '1' : '0');
+        }
+        return out;
     };
-    bitstring &operator=(bitstring &&other)
+
+    /**
+     * @brief Get the number of bits in the bitstring.
+     */
+    size_t size() const
     {
-        this->assign(other.begin(), other.end());
-        this->min = other.min;
-        this->max = other.max;
-        this->groups = other.groups;
-        assertions();
-        return *this;
+        return this->bits;
     };
 
-    // Overload the equality operator.
-    bool operator==(const bitstring &other) const
+    /**
+     * @brief Get the bit at the given index.
+     */
+    uint8_t operator[](size_t index) const
     {
-        return this->min == other.min && this->max == other.max && this->groups == other.groups && std::equal(this->begin(), this->end(), other.begin());
+        assert(index < this->bits);
+        return (this->words[index / bitops::word_bits] & bitops::mask_of(index)) != 0;
     };
 
-    // Overload the output operator.
-    friend std::ostream &operator<<(std::ostream &out, const bitstring &c)
+    /**
+     * @brief Set the bit at the given index.
+     * @param index The index of the bit to set.
+     * @param value The value to set (0 or 1).
+     */
+    void set(size_t index, uint8_t value)
     {
-        for (auto val : c)
+        assert(index < this->bits);
+        assert(value <= 1);
+        auto word = index / bitops::word_bits;
+        auto bit = (this->words[word] & bitops::mask_of(index)) != 0;
+        if (bit != (value != 0))
         {
-            out << std::to_string(val);
+            this->xor_word(word, bitops::mask_of(index));
         }
-        return out;
+    };
+
+    /**
+     * @brief Flip the bits of one word selected by a mask, updating the hash incrementally.
+     * @param word The index of the word.
+     * @param mask The bits to flip. Must not touch the padding bits.
+     */
+    void xor_word(size_t word, uint64_t mask)
+    {
+        assert(word < this->words.size());
+        assert(word + 1 < this->words.size() || (mask & ~bitops::tail_mask(this->bits)) == 0);
+        auto old = this->words[word];
+        this->words[word] ^= mask;
+        this->hash_value ^= bitops::mix(old, word) ^ bitops::mix(this->words[word], word);
+    };
+
+    /**
+     * @brief Get the packed words of the bitstring.
+     */
+    std::span<const uint64_t> get_words() const
+    {
+        return this->words;
+    };
+
+    /**
+     * @brief Count the bits that differ from another bitstring of the same size.
+     * @param other The bitstring to compare with.
+     * @return The hamming distance.
+     */
+    size_t hamming_distance(const bitstring &other) const
+    {
+        assert(this->bits == other.bits);
+        return bitops::hamming_distance(this->words, other.words);
+    };
+
+    /**
+     * @brief Get the hash of the bits of the bitstring.
+     * The hash is maintained incrementally, so this is O(1).
+     */
+    uint64_t hash() const
+    {
+        return this->hash_value;
     };
 
     /**
      * @brief Randomize the bitstring.
-     * Randomize the bitstring by setting each bit to a random value.
+     * Randomize the bitstring by filling each word with random bits.
      */
     void randomize()
     {
-        std::uniform_int_distribution<uint8_t> distribution(0, 1);
-        for (size_t i = 0; i < this->size(); i++)
+        get_generator().fill(this->words);
+        if (!this->words.empty())
         {
-            this->at(i) = distribution(get_generator());
+            this->words.back() &= bitops::tail_mask(this->bits);
         }
+        this->hash_value = bitops::hash(this->words);
     };
 
     /**
@@ -127,6 +314,7 @@ public:
         assert (this->size() > 0);
         assert (this->groups > 0);
         auto group_size = this->size() / this->groups;
+        result.reserve(this->groups);
         for (size_t i = 0; i < this->size(); i += group_size)
         {
             result.push_back(this->decode(i, i + group_size - 1));
@@ -143,17 +331,12 @@ public:
      */
     double decode(size_t start, size_t end) const
     {
-        // First convert the binary number to an unsigned long long.
         assert(end < this->size());
         assert(start < end);
         assert(end - start == this->size() / this->groups - 1);
-        uint32_t val = 0;
-        for (size_t i = start; i <= end; i++)
-        {
-            val *= 2;
-            val += this->at(i);
-        }
-        // Then convert the unsigned long long to a double.
+        // First read the group as an unsigned integer.
+        auto val = bitops::extract(this->words, start, end - start + 1);
+        // Then convert it to a double.
         auto divided = (double) val / max_full_size();
         assert(divided >= 0.0 && divided <= 1.0);
         auto range = max - min;
@@ -166,7 +349,6 @@ public:
      * @brief Encode the bitstring.
      * Encode the bitstring by converting the given vector of doubles to a binary number.
      * @param val The vector of doubles to encode.
-     * @return The encoded bitstring.
      */
     void encode(std::span<double> val)
     {
@@ -176,16 +358,16 @@ public:
         {
             assert(v >= min && v <= max);
         }
-        // Encode the vector.
-        this->resize(val.size());
-        for (auto v : val)
+        // Encode the vector one group at a time.
+        auto group_size = this->size() / this->groups;
+        for (size_t group = 0; group < val.size(); group++)
         {
             // First convert the double to an unsigned long long.
-            auto int_val = (uint64_t)((v - min) * max_full_size() / (max - min));
-            // Then convert the unsigned long long to a binary number.
-            for (size_t i = 0; i < this->size(); i++)
+            auto int_val = (uint64_t)((val[group] - min) * max_full_size() / (max - min));
+            // Then write it out as a binary number.
+            for (size_t i = 0; i < group_size; i++)
             {
-                this->at(this->size() - i - 1) = int_val & 1;
+                this->set((group + 1) * group_size - i - 1, int_val & 1);
                 int_val /= 2;
             }
         }
@@ -197,7 +379,8 @@ public:
      */
     void flip(size_t index)
     {
-        this->at(index) ^= 1;
+        assert(index < this->bits);
+        this->xor_word(index / bitops::word_bits, bitops::mask_of(index));
     };
 
     /**
@@ -214,7 +397,7 @@ public:
      */
     double max_full_size() const
     {
-        return std::pow(2, this->size() / this->groups) - 1;
+        return std::ldexp(1.0, (int)(this->size() / this->groups)) - 1;
     };
 
     /**
@@ -243,4 +426,13 @@ public:
     {
         return this->groups;
     };
-};
\ No newline at end of file
+};
+
+template <>
+struct std::hash<bitstring>
+{
+    size_t operator()(const bitstring &bits) const noexcept
+    {
+        return (size_t)bits.hash();
+    }
+};
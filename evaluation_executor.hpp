@@ -0,0 +1,204 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cassert>
+
+#include "batch_decode.hpp"
+#include "random.hpp"
+#include "Functions/function.hpp"
+
+/**
+ * A pool of worker threads that evaluates decoded blocks of genomes while
+ * the submitting threads go on breeding.
+ * A block is submitted in three steps: acquire() a ticket, decode into
+ * input(ticket), then submit() it with the objective and the stream to
+ * seat while evaluating it. collect() waits for the values and release()
+ * recycles the ticket's buffers, so once enough tickets exist nothing is
+ * allocated. At most capacity blocks are queued or being evaluated at any
+ * time; acquire() blocks beyond that, which keeps fast breeders from
+ * running arbitrarily far ahead. Finished but uncollected blocks do not
+ * count, so runs sharing one executor cannot starve each other.
+ * All methods are thread-safe; one executor can serve every run of an
+ * experiment.
+ */
+class EvaluationExecutor
+{
+private:
+    enum class State
+    {
+        free,
+        filling,
+        queued,
+        done
+    };
+
+    struct Job
+    {
+        DecodedPopulation input;
+        std::vector<double> values;
+        const OptimizationFunction *function = nullptr;
+        rng::Stream stream;
+        State state = State::free;
+    };
+
+    size_t capacity;
+    std::mutex mutex;
+    std::condition_variable work_ready, job_done, space_free;
+    std::vector<std::unique_ptr<Job>> jobs;
+    std::vector<size_t> free_jobs;
+    // Submitted tickets in order, a ring buffer of capacity entries.
+    std::vector<size_t> queue;
+    size_t queue_head = 0;
+    size_t queued = 0;
+    // Blocks queued or being evaluated.
+    size_t pending = 0;
+    bool stopping = false;
+    std::vector<std::jthread> workers;
+
+    void work()
+    {
+        std::unique_lock lock(this->mutex);
+        while (true)
+        {
+            this->work_ready.wait(lock, [&]
+                                  { return this->stopping || this->queued > 0; });
+            if (this->queued == 0)
+            {
+                return;
+            }
+            auto &job = *this->jobs[this->queue[this->queue_head]];
+            this->queue_head = (this->queue_head + 1) % this->capacity;
+            this->queued--;
+            lock.unlock();
+            get_generator() = job.stream;
+            job.function->evalBatch(job.input, job.values);
+            lock.lock();
+            job.state = State::done;
+            this->pending--;
+            this->job_done.notify_all();
+            this->space_free.notify_one();
+        }
+    }
+
+public:
+    /**
+     * @brief Start the workers.
+     * @param worker_count The number of worker threads.
+     * @param queue_capacity The number of blocks that may be queued or in evaluation, 2 per worker by default.
+     */
+    explicit EvaluationExecutor(size_t worker_count, size_t queue_capacity = 0) : capacity(queue_capacity > 0 ? queue_capacity : 2 * worker_count),
+                                                                                 queue(queue_capacity > 0 ? queue_capacity : 2 * worker_count)
+    {
+        assert(worker_count > 0);
+        for (size_t i = 0; i < worker_count; i++)
+        {
+            this->workers.emplace_back([this]
+                                       { work(); });
+        }
+    }
+
+    /**
+     * @brief Finish the queued blocks and stop the workers.
+     */
+    ~EvaluationExecutor()
+    {
+        {
+            std::lock_guard lock(this->mutex);
+            this->stopping = true;
+        }
+        this->work_ready.notify_all();
+        this->workers.clear();
+    }
+
+    EvaluationExecutor(const EvaluationExecutor &) = delete;
+    EvaluationExecutor &operator=(const EvaluationExecutor &) = delete;
+
+    size_t get_workers() const { return this->workers.size(); }
+
+    /**
+     * @brief Get a ticket for a new block, waiting while capacity blocks are pending.
+     */
+    size_t acquire()
+    {
+        std::unique_lock lock(this->mutex);
+        this->space_free.wait(lock, [&]
+                              { return this->pending < this->capacity; });
+        this->pending++;
+        size_t ticket;
+        if (this->free_jobs.empty())
+        {
+            ticket = this->jobs.size();
+            this->jobs.push_back(std::make_unique<Job>());
+            this->free_jobs.reserve(this->jobs.size());
+        }
+        else
+        {
+            ticket = this->free_jobs.back();
+            this->free_jobs.pop_back();
+        }
+        this->jobs[ticket]->state = State::filling;
+        return ticket;
+    }
+
+    /**
+     * @brief Get the matrix to decode a ticket's block into, before submit().
+     */
+    DecodedPopulation &input(size_t ticket)
+    {
+        // acquire() on another thread may grow jobs; the Job itself never moves.
+        std::lock_guard lock(this->mutex);
+        auto &job = *this->jobs[ticket];
+        assert(job.state == State::filling);
+        return job.input;
+    }
+
+    /**
+     * @brief Queue a decoded block for evaluation.
+     * @param ticket The ticket from acquire().
+     * @param function The objective; must outlive the evaluation.
+     * @param stream The stream the worker's generator is seated on for the block, as Algorithm::evaluate seats it.
+     */
+    void submit(size_t ticket, const OptimizationFunction &function, rng::Stream stream)
+    {
+        {
+            std::lock_guard lock(this->mutex);
+            auto &job = *this->jobs[ticket];
+            assert(job.state == State::filling);
+            job.values.resize(job.input.get_columns());
+            job.function = &function;
+            job.stream = stream;
+            job.state = State::queued;
+            this->queue[(this->queue_head + this->queued) % this->capacity] = ticket;
+            this->queued++;
+        }
+        this->work_ready.notify_one();
+    }
+
+    /**
+     * @brief Wait until a block is evaluated.
+     * @return The objective function value of every column of the block, valid until release().
+     */
+    std::span<const double> collect(size_t ticket)
+    {
+        std::unique_lock lock(this->mutex);
+        auto &job = *this->jobs[ticket];
+        this->job_done.wait(lock, [&]
+                            { return job.state == State::done; });
+        return job.values;
+    }
+
+    /**
+     * @brief Return a collected ticket's buffers for reuse.
+     */
+    void release(size_t ticket)
+    {
+        std::lock_guard lock(this->mutex);
+        assert(this->jobs[ticket]->state == State::done);
+        this->jobs[ticket]->state = State::free;
+        this->free_jobs.push_back(ticket);
+    }
+};
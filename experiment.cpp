@@ -0,0 +1,486 @@
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include "experiment.hpp"
+#include "job_scheduler.hpp"
+#include "Functions/dejong.hpp"
+#include "Algorithms/engine_factory.hpp"
+#include "Algorithms/simple_ga.hpp"
+#include "Algorithms/chc.hpp"
+
+namespace
+{
+    // Parse a whole option value as a number; anything left over fails.
+    template <typename Number>
+    bool parse_number(const std::string &text, Number &value)
+    {
+        auto end = text.data() + text.size();
+        auto [last, error] = std::from_chars(text.data(), end, value);
+        return error == std::errc() && last == end;
+    }
+}
+
+OptimizationFunction *find_function(const std::string &name)
+{
+    static dejong::DeJong1 dejong1;
+    static dejong::DeJong2 dejong2;
+    static dejong::DeJong3 dejong3;
+    static dejong::DeJong4 dejong4;
+    static dejong::DeJong5 dejong5;
+    if (name == "dejong1")
+    {
+        return &dejong1;
+    }
+    if (name == "dejong2")
+    {
+        return &dejong2;
+    }
+    if (name == "dejong3")
+    {
+        return &dejong3;
+    }
+    if (name == "dejong4")
+    {
+        return &dejong4;
+    }
+    if (name == "dejong5")
+    {
+        return &dejong5;
+    }
+    return nullptr;
+}
+
+bool read_experiments(const std::string &filename, std::vector<Experiment> &experiments)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        std::cout << "Could not open file " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    // The line of every output file so far.
+    std::unordered_map<std::string, size_t> outputs;
+    for (size_t line_number = 1; std::getline(file, line); line_number++)
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string algorithm;
+        if (!(fields >> algorithm))
+        {
+            continue;
+        }
+        Experiment experiment;
+        std::string function;
+        // Counts are read signed: >> into a size_t would wrap a negative one.
+        long long population_size, num_of_generations, chromosome_size, number_of_chromosomes, num_of_runs;
+        fields >> function >> population_size >> num_of_generations >> experiment.crossover_prob >> experiment.mutation_prob >> chromosome_size >> number_of_chromosomes >> num_of_runs >> experiment.filename;
+        experiment.function = find_function(function);
+        auto island = algorithm == "island_simple_ga" || algorithm == "island_chc";
+        auto valid = !fields.fail() && experiment.function != nullptr && (algorithm == "simple_ga" || algorithm == "chc" || island || algorithm == "steady_state");
+        if (!valid)
+        {
+            std::cout << filename << ":" << line_number << ": expected <simple_ga|chc|island_simple_ga|island_chc|steady_state> <dejong1-5> <population> <generations> <crossover> <mutation> <chromosome size> <chromosomes> <runs> <output> [key=value...]" << std::endl;
+            return false;
+        }
+        std::string problem;
+        if (auto [earlier, added] = outputs.emplace(experiment.filename, line_number); !added)
+        {
+            problem = experiment.filename + " is already the output of line " + std::to_string(earlier->second);
+        }
+        else if (population_size <= 0 || num_of_generations <= 0)
+        {
+            problem = "population and generations must be positive";
+        }
+        else if (!(experiment.crossover_prob >= 0.0 && experiment.crossover_prob <= 1.0) || !(experiment.mutation_prob >= 0.0 && experiment.mutation_prob <= 1.0))
+        {
+            problem = "crossover and mutation probabilities must be between 0 and 1";
+        }
+        else if (chromosome_size < 1 || chromosome_size > 64)
+        {
+            problem = "chromosome size must be between 1 and 64";
+        }
+        else if (number_of_chromosomes != (long long)experiment.function->getNumberOfVariables())
+        {
+            problem = function + " takes " + std::to_string(experiment.function->getNumberOfVariables()) + " chromosomes";
+        }
+        else if (num_of_runs < 0)
+        {
+            problem = "runs must not be negative";
+        }
+        std::string option;
+        auto island_setting = false, steady_state_setting = false;
+        while (problem.empty() && fields >> option)
+        {
+            auto equals = option.find('=');
+            auto key = option.substr(0, equals);
+            auto value = equals == std::string::npos ? std::string() : option.substr(equals + 1);
+            if (equals == std::string::npos)
+            {
+                problem = "expected key=value instead of " + option;
+            }
+            else if (key == "cache")
+            {
+                if (!parse_number(value, experiment.cache_entries) || experiment.cache_entries == 0)
+                {
+                    problem = "cache takes a positive number of entries";
+                }
+                else if (!experiment.function->isDeterministic())
+                {
+                    problem = function + " is noisy, so its values cannot be cached";
+                }
+            }
+            else if (key == "delta")
+            {
+                if (value != "on" && value != "off")
+                {
+                    problem = "delta takes on or off";
+                }
+                else if (value == "on" && !experiment.function->isSeparable())
+                {
+                    problem = function + " is not separable, so it has no delta evaluation";
+                }
+                experiment.delta_evaluation = value == "on";
+            }
+            else if (key == "lockstep")
+            {
+                if (!parse_number(value, experiment.lockstep_lanes) || experiment.lockstep_lanes == 0)
+                {
+                    problem = "lockstep takes a positive number of runs";
+                }
+                else if (algorithm != "simple_ga")
+                {
+                    problem = "lockstep is only available for simple_ga";
+                }
+            }
+            else if (key == "islands")
+            {
+                island_setting = true;
+                if (!parse_number(value, experiment.islands) || experiment.islands < 2)
+                {
+                    problem = "islands takes a number of at least 2";
+                }
+            }
+            else if (key == "interval")
+            {
+                island_setting = true;
+                if (!parse_number(value, experiment.migration_interval) || experiment.migration_interval == 0)
+                {
+                    problem = "interval takes a positive number of generations";
+                }
+            }
+            else if (key == "migrants")
+            {
+                island_setting = true;
+                if (!parse_number(value, experiment.migrants) || experiment.migrants == 0)
+                {
+                    problem = "migrants takes a positive number of members";
+                }
+            }
+            else if (key == "topology")
+            {
+                island_setting = true;
+                if (value == "ring")
+                {
+                    experiment.topology = MigrationTopology::ring;
+                }
+                else if (value == "fully_connected")
+                {
+                    experiment.topology = MigrationTopology::fully_connected;
+                }
+                else if (value == "random")
+                {
+                    experiment.topology = MigrationTopology::random;
+                }
+                else
+                {
+                    problem = "topology takes ring, fully_connected or random";
+                }
+            }
+            else if (key == "offspring")
+            {
+                steady_state_setting = true;
+                if (!parse_number(value, experiment.offspring) || experiment.offspring == 0 || experiment.offspring > (size_t)population_size)
+                {
+                    problem = "offspring takes a positive number up to the population size";
+                }
+            }
+            else if (key == "replacement")
+            {
+                steady_state_setting = true;
+                if (value == "worst")
+                {
+                    experiment.replacement = ReplacementStrategy::worst;
+                }
+                else if (value == "random")
+                {
+                    experiment.replacement = ReplacementStrategy::random;
+                }
+                else if (value == "tournament_loser")
+                {
+                    experiment.replacement = ReplacementStrategy::tournament_loser;
+                }
+                else
+                {
+                    problem = "replacement takes worst, random or tournament_loser";
+                }
+            }
+            else
+            {
+                problem = "unknown setting " + key;
+            }
+        }
+        if (problem.empty() && experiment.lockstep_lanes > 0 && (experiment.cache_entries > 0 || experiment.delta_evaluation))
+        {
+            problem = "lockstep cannot be combined with cache or delta";
+        }
+        else if (problem.empty() && island_setting && !island)
+        {
+            problem = "islands, interval, migrants and topology are only available for island_simple_ga and island_chc";
+        }
+        else if (problem.empty() && steady_state_setting && algorithm != "steady_state")
+        {
+            problem = "offspring and replacement are only available for steady_state";
+        }
+        else if (problem.empty() && island)
+        {
+            // An island keeps the members it sends apart from those its sources replace.
+            auto sources = experiment.topology == MigrationTopology::fully_connected ? experiment.islands - 1 : 1;
+            if (experiment.migrants > (size_t)population_size / (sources + 1))
+            {
+                problem = "an island cannot send and receive " + std::to_string(experiment.migrants) + " migrants per source from a population of " + std::to_string(population_size);
+            }
+        }
+        if (!problem.empty())
+        {
+            std::cout << filename << ":" << line_number << ": " << problem << std::endl;
+            return false;
+        }
+        experiment.population_size = (size_t)population_size;
+        experiment.num_of_generations = (size_t)num_of_generations;
+        experiment.chromosome_size = (size_t)chromosome_size;
+        experiment.number_of_chromosomes = (size_t)number_of_chromosomes;
+        experiment.num_of_runs = (size_t)num_of_runs;
+        if (algorithm == "chc")
+        {
+            experiment.algorithm = ExperimentAlgorithm::chc;
+        }
+        else if (algorithm == "island_simple_ga")
+        {
+            experiment.algorithm = ExperimentAlgorithm::island_simple_ga;
+        }
+        else if (algorithm == "island_chc")
+        {
+            experiment.algorithm = ExperimentAlgorithm::island_chc;
+        }
+        else if (algorithm == "steady_state")
+        {
+            experiment.algorithm = ExperimentAlgorithm::steady_state;
+        }
+        else
+        {
+            experiment.algorithm = ExperimentAlgorithm::simple_ga;
+        }
+        experiments.push_back(std::move(experiment));
+    }
+    return true;
+}
+
+void write_run(ResultWriter &writer, uint32_t file, size_t run, const std::vector<GenerationPerformance> &run_performance)
+{
+    ResultRecord record;
+    record.file = file;
+    record.integer_fields = 2;
+    record.real_fields = 6;
+    // Runs that met a stopping criterion have fewer generations.
+    for (size_t generation = 0; generation < run_performance.size(); generation++)
+    {
+        const auto &performance = run_performance[generation];
+        record.integers[0] = run;
+        record.integers[1] = generation;
+        record.reals = {performance.best_fitness, performance.average_fitness, performance.worst_fitness, performance.best_objective_function_value, performance.average_objective_function_value, performance.worst_objective_function_value};
+        writer.push(record);
+    }
+}
+
+namespace
+{
+    // Consecutive runs of one experiment scheduled together.
+    struct Job
+    {
+        size_t experiment;
+        size_t first_run;
+        size_t runs;
+    };
+
+    /**
+     * @brief Create the engine for one run of an experiment.
+     * Delta evaluation needs the per-variable terms of the runtime engines'
+     * populations, so it bypasses the specialized engines. The islands of
+     * an island model are runtime engines, and so is the steady-state GA.
+     */
+    std::unique_ptr<Algorithm> make_algorithm(const Experiment &experiment)
+    {
+        if (experiment.algorithm == ExperimentAlgorithm::island_simple_ga || experiment.algorithm == ExperimentAlgorithm::island_chc)
+        {
+            auto engine = experiment.algorithm == ExperimentAlgorithm::island_chc ? IslandEngine::chc : IslandEngine::simple_ga;
+            auto algorithm = std::make_unique<IslandModel>(engine, experiment.islands, experiment.population_size, experiment.num_of_generations, experiment.crossover_prob, experiment.mutation_prob, experiment.chromosome_size, experiment.number_of_chromosomes, *experiment.function, experiment.migration_interval, experiment.migrants, experiment.topology);
+            algorithm->set_delta_evaluation(experiment.delta_evaluation);
+            return algorithm;
+        }
+        if (experiment.algorithm == ExperimentAlgorithm::steady_state)
+        {
+            auto algorithm = std::make_unique<SteadyStateGA>(experiment.population_size, experiment.num_of_generations, experiment.crossover_prob, experiment.mutation_prob, experiment.chromosome_size, experiment.number_of_chromosomes, *experiment.function, experiment.offspring, experiment.replacement);
+            algorithm->set_delta_evaluation(experiment.delta_evaluation);
+            return algorithm;
+        }
+        auto chc = experiment.algorithm == ExperimentAlgorithm::chc;
+        std::unique_ptr<Algorithm> algorithm;
+        if (experiment.delta_evaluation)
+        {
+            if (chc)
+            {
+                algorithm = std::make_unique<CHC>(experiment.population_size, experiment.num_of_generations, experiment.crossover_prob, experiment.mutation_prob, experiment.chromosome_size, experiment.number_of_chromosomes, *experiment.function);
+            }
+            else
+            {
+                algorithm = std::make_unique<SimpleGA>(experiment.population_size, experiment.num_of_generations, experiment.crossover_prob, experiment.mutation_prob, experiment.chromosome_size, experiment.number_of_chromosomes, *experiment.function);
+            }
+            algorithm->set_delta_evaluation(true);
+            return algorithm;
+        }
+        return chc ? make_chc(experiment.population_size, experiment.num_of_generations, experiment.crossover_prob, experiment.mutation_prob, experiment.chromosome_size, experiment.number_of_chromosomes, *experiment.function)
+                   : make_simple_ga(experiment.population_size, experiment.num_of_generations, experiment.crossover_prob, experiment.mutation_prob, experiment.chromosome_size, experiment.number_of_chromosomes, *experiment.function);
+    }
+
+    /**
+     * @brief Get the threads one run of an experiment occupies.
+     * An island model runs every island on a thread of its own.
+     */
+    size_t run_width(const Experiment &experiment)
+    {
+        auto island = experiment.algorithm == ExperimentAlgorithm::island_simple_ga || experiment.algorithm == ExperimentAlgorithm::island_chc;
+        return island ? experiment.islands : 1;
+    }
+
+    // The runs of one experiment while they are in the pool.
+    struct Progress
+    {
+        uint32_t file;
+        // Shared by every run of the experiment, if it has one.
+        std::shared_ptr<FitnessCache> cache;
+        // Finished runs wait here until every earlier run has been written.
+        std::mutex mutex;
+        std::vector<std::vector<GenerationPerformance>> run_performances;
+        std::vector<bool> finished;
+        size_t next_run = 0;
+    };
+}
+
+void run_experiments(const std::vector<Experiment> &experiments, uint64_t seed)
+{
+    ResultWriter writer;
+    // Every run is a job, except that lockstep experiments put lockstep_lanes runs in one.
+    std::vector<Job> jobs;
+    std::vector<double> costs;
+    size_t total_runs = 0, width = 1;
+    std::vector<Progress> progress(experiments.size());
+    for (size_t e = 0; e < experiments.size(); e++)
+    {
+        const auto &experiment = experiments[e];
+        progress[e].file = writer.open(experiment.filename, performance_header);
+        progress[e].run_performances.resize(experiment.num_of_runs);
+        progress[e].finished.resize(experiment.num_of_runs);
+        if (experiment.cache_entries > 0)
+        {
+            progress[e].cache = std::make_shared<FitnessCache>(experiment.chromosome_size * experiment.number_of_chromosomes, experiment.cache_entries);
+        }
+        auto runs_per_job = std::max<size_t>(1, experiment.lockstep_lanes);
+        for (size_t run = 0; run < experiment.num_of_runs; run += runs_per_job)
+        {
+            auto runs = std::min(runs_per_job, experiment.num_of_runs - run);
+            jobs.push_back({e, run, runs});
+            costs.push_back((double)(runs * run_width(experiment)) * JobScheduler::run_cost(experiment.population_size, experiment.num_of_generations, experiment.chromosome_size * experiment.number_of_chromosomes));
+        }
+        if (experiment.num_of_runs > 0)
+        {
+            width = std::max(width, run_width(experiment));
+        }
+        total_runs += experiment.num_of_runs;
+        if (experiment.num_of_runs == 0)
+        {
+            writer.close(progress[e].file);
+        }
+    }
+
+    // Runs are spread over the cores first; cores left over go to the threads inside each run.
+    // The widest run sets how many jobs fit in the thread budget at once.
+    parallel::enable_nesting();
+    auto budget = (size_t)std::max(1, omp_get_max_threads());
+    auto workers = std::clamp(std::min(jobs.size(), budget / width), (size_t)1, budget);
+    auto run_threads = parallel::threads_per_job(workers);
+    JobScheduler scheduler(workers);
+    scheduler.run(costs, [&](size_t j)
+                  {
+        auto [e, first_run, runs] = jobs[j];
+        const auto &experiment = experiments[e];
+        auto &state = progress[e];
+        // Every experiment draws from streams of its own, whichever runs share its seed.
+        auto experiment_seed = rng::derive_seed(seed, experiment.filename);
+        std::vector<std::vector<GenerationPerformance>> run_performances;
+        if (experiment.lockstep_lanes > 0)
+        {
+            auto lockstep = make_lockstep_simple_ga(experiment.population_size, experiment.num_of_generations, experiment.crossover_prob, experiment.mutation_prob, experiment.chromosome_size, experiment.number_of_chromosomes, *experiment.function, runs);
+            if (lockstep)
+            {
+                lockstep->set_threads(run_threads);
+                lockstep->set_seed(experiment_seed, first_run);
+                run_performances = lockstep->run();
+            }
+        }
+        // Configurations without a lockstep engine run one engine per run.
+        for (auto run = first_run + run_performances.size(); run < first_run + runs; run++)
+        {
+            auto algorithm = make_algorithm(experiment);
+            algorithm->set_threads(run_threads);
+            algorithm->set_cache(state.cache);
+            algorithm->set_seed(experiment_seed, run);
+            run_performances.push_back(algorithm->run());
+        }
+
+        std::lock_guard lock(state.mutex);
+        for (size_t k = 0; k < runs; k++)
+        {
+            state.run_performances[first_run + k] = std::move(run_performances[k]);
+            state.finished[first_run + k] = true;
+        }
+        for (; state.next_run < experiment.num_of_runs && state.finished[state.next_run]; state.next_run++)
+        {
+            write_run(writer, state.file, state.next_run, state.run_performances[state.next_run]);
+            state.run_performances[state.next_run] = {};
+        }
+        if (state.next_run == experiment.num_of_runs)
+        {
+            writer.close(state.file);
+        } });
+    writer.finish();
+    if (!jobs.empty())
+    {
+        std::cout << experiments.size() << " experiments, " << total_runs << " runs in " << std::chrono::duration<double>(scheduler.get_elapsed()).count()
+                  << " s, " << (int)std::round(100.0 * scheduler.utilization()) << "% utilization" << std::endl;
+    }
+    for (size_t e = 0; e < experiments.size(); e++)
+    {
+        if (progress[e].cache)
+        {
+            std::cout << experiments[e].filename << ": " << progress[e].cache->hits() << " cache hits, "
+                      << (int)std::round(100.0 * progress[e].cache->hit_rate()) << "% hit rate" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Functions/function.hpp"
+#include "Algorithms/algorithm.hpp"
+#include "Algorithms/island_model.hpp"
+#include "Algorithms/steady_state_ga.hpp"
+#include "result_writer.hpp"
+
+/**
+ * The algorithm of an experiment.
+ */
+enum class ExperimentAlgorithm
+{
+    simple_ga,
+    chc,
+    // An IslandModel of SimpleGA or CHC islands.
+    island_simple_ga,
+    island_chc,
+    // A SteadyStateGA.
+    steady_state
+};
+
+/**
+ * A number of runs of one algorithm configuration on one function, written
+ * to one file with a row per run and generation.
+ */
+struct Experiment
+{
+    ExperimentAlgorithm algorithm;
+    OptimizationFunction *function;
+    size_t population_size;
+    size_t num_of_generations;
+    double crossover_prob;
+    double mutation_prob;
+    size_t chromosome_size;
+    size_t number_of_chromosomes;
+    size_t num_of_runs;
+    std::string filename;
+    // Optional settings, given as key=value after the output file.
+    // Entries of a genome cache shared by the experiment's runs (cache=), 0 for none.
+    size_t cache_entries = 0;
+    // Re-evaluate separable functions term by term (delta=on), on the runtime engines.
+    bool delta_evaluation = false;
+    // Evolve this many runs together in one lockstep engine (lockstep=), 0 for one engine per run.
+    size_t lockstep_lanes = 0;
+    // The island model of the island algorithms (islands=, interval=, migrants=, topology=).
+    size_t islands = 4;
+    size_t migration_interval = 10;
+    size_t migrants = 1;
+    MigrationTopology topology = MigrationTopology::ring;
+    // The steps of a steady_state experiment (offspring=, replacement=).
+    size_t offspring = 2;
+    ReplacementStrategy replacement = ReplacementStrategy::worst;
+};
+
+/**
+ * The header of a performance file, one row per run and generation.
+ */
+inline constexpr const char *performance_header = "Run,Generation,Best Fitness,Average Fitness,Worst Fitness,Best Value,Average Value,Worst Value";
+
+/**
+ * @brief Queue the rows of one run's series for a performance file.
+ * @param writer The writer of the file.
+ * @param file The file's id from writer.open().
+ * @param run The run's number in the file.
+ * @param run_performance The run's series.
+ */
+void write_run(ResultWriter &writer, uint32_t file, size_t run, const std::vector<GenerationPerformance> &run_performance);
+
+/**
+ * @brief Get the function of a name, dejong1 to dejong5.
+ * @return The function, shared by every caller, or nullptr for an unknown name.
+ */
+OptimizationFunction *find_function(const std::string &name);
+
+/**
+ * @brief Read experiments from a text file.
+ * Every line holds one experiment as whitespace-separated fields:
+ * algorithm (simple_ga, chc, island_simple_ga, island_chc or steady_state), function (dejong1 to dejong5), population
+ * size, generations, crossover probability, mutation probability,
+ * chromosome size, number of chromosomes, runs and output file, then
+ * optional key=value settings: cache=<entries> shares a genome cache of
+ * that many entries between the runs, delta=<on|off> turns on delta
+ * evaluation and lockstep=<runs> evolves that many runs of a simple_ga
+ * together; the island algorithms take islands=<count>, interval=<generations>,
+ * migrants=<members> and topology=<ring|fully_connected|random>, and
+ * steady_state takes offspring=<per step> and
+ * replacement=<worst|random|tournament_loser>. Blank lines and everything after a # are ignored. Population
+ * and generations must be positive, probabilities between 0 and 1, the
+ * chromosome size between 1 and 64 bits, and the chromosomes as many as the
+ * function's variables, and no two experiments may write the same output
+ * file. Only deterministic functions can use a cache and
+ * only separable ones delta evaluation; lockstep runs use neither. An
+ * island model needs at least 2 islands, and the members an island sends
+ * and receives must fit in its population. A step breeds at most a
+ * population of offspring.
+ * @param filename The file to read.
+ * @param experiments Receives the experiments.
+ * @return Whether the file was read; otherwise the problem is printed.
+ */
+bool read_experiments(const std::string &filename, std::vector<Experiment> &experiments);
+
+/**
+ * @brief Run experiments as one pool of jobs, one per run.
+ * All runs of all experiments share one JobScheduler, longest first, so
+ * short experiments fill the cores around long ones. A run's rows are
+ * queued for a ResultWriter once every earlier run of its experiment has
+ * finished, so files keep run order. Run r of an experiment draws from the
+ * streams of run r of a seed derived from the seed and its output file name
+ * (rng::derive_seed), so experiments with the same settings still draw
+ * different numbers, and a file does not depend on the other experiments in
+ * the pool or on how the runs were scheduled, nor on whether they ran in
+ * lockstep. An island run needs a thread per island,
+ * so pools with island experiments run fewer jobs at once to stay within
+ * the OpenMP thread budget. The hit rate
+ * of every experiment's cache is printed at the end.
+ */
+void run_experiments(const std::vector<Experiment> &experiments, uint64_t seed);
@@ -0,0 +1,140 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <utility>
+
+#include "bitstring.hpp"
+
+/**
+ * Population-level checks built on the incrementally maintained genome hashes.
+ * The fingerprint of a population is the sum of its (re-mixed) genome hashes,
+ * so it does not depend on the order of the members and is O(n) to compute.
+ * Exact genome comparisons are only made between members whose hashes are
+ * equal. Scratch buffers are kept between calls.
+ */
+class PopulationFingerprint
+{
+private:
+    std::vector<std::pair<uint64_t, size_t>> first, second;
+    std::vector<size_t> duplicates;
+
+    template <typename Range, typename GenomeOf>
+    static void sorted_hashes(const Range &population, GenomeOf genome_of, std::vector<std::pair<uint64_t, size_t>> &out)
+    {
+        out.clear();
+        for (size_t i = 0; i < population.size(); i++)
+        {
+            out.emplace_back(std::invoke(genome_of, population[i]).hash(), i);
+        }
+        std::sort(out.begin(), out.end());
+    }
+
+public:
+    /**
+     * @brief Grow the scratch buffers for populations of up to the given size, so no later call allocates.
+     */
+    void reserve(size_t members)
+    {
+        first.reserve(members);
+        second.reserve(members);
+        duplicates.reserve(members);
+    }
+
+    /**
+     * @brief Get the order-independent fingerprint of a population.
+     * @param population The population, anything with size() and operator[].
+     * @param genome_of Maps a member of the population to its genome.
+     */
+    template <typename Range, typename GenomeOf>
+    static uint64_t of(const Range &population, GenomeOf genome_of)
+    {
+        uint64_t fingerprint = 0;
+        for (size_t i = 0; i < population.size(); i++)
+        {
+            fingerprint += bitops::mix(std::invoke(genome_of, population[i]).hash(), 0);
+        }
+        return fingerprint;
+    }
+
+    /**
+     * @brief Check if two populations hold the same genomes, in any order.
+     * Equivalent to std::is_permutation on the genomes. Differing fingerprints
+     * answer in O(n); otherwise the hashes are sorted and only genomes with
+     * equal hashes are compared.
+     */
+    template <typename Range, typename GenomeOf>
+    bool same_members(const Range &a, const Range &b, GenomeOf genome_of)
+    {
+        if (a.size() != b.size() || of(a, genome_of) != of(b, genome_of))
+        {
+            return false;
+        }
+        sorted_hashes(a, genome_of, first);
+        sorted_hashes(b, genome_of, second);
+        for (size_t start = 0; start < first.size();)
+        {
+            auto end = start;
+            while (end < first.size() && first[end].first == first[start].first)
+            {
+                if (second[end].first != first[start].first)
+                {
+                    return false;
+                }
+                end++;
+            }
+            // Members with the same hash are almost always the same genome;
+            // compare them exactly to rule out collisions.
+            auto same = std::is_permutation(
+                first.begin() + (std::ptrdiff_t)start, first.begin() + (std::ptrdiff_t)end,
+                second.begin() + (std::ptrdiff_t)start, second.begin() + (std::ptrdiff_t)end,
+                [&](const auto &x, const auto &y)
+                { return std::invoke(genome_of, a[x.second]) == std::invoke(genome_of, b[y.second]); });
+            if (!same)
+            {
+                return false;
+            }
+            start = end;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Find the members whose genome already occurs earlier in the population.
+     * @param population The population.
+     * @param genome_of Maps a member of the population to its genome.
+     * @param duplicates Receives the indices of the duplicates, in increasing order.
+     */
+    template <typename Range, typename GenomeOf>
+    void find_duplicates(const Range &population, GenomeOf genome_of, std::vector<size_t> &duplicates)
+    {
+        duplicates.clear();
+        // The number of duplicates varies between calls; reserve for the most.
+        duplicates.reserve(population.size());
+        sorted_hashes(population, genome_of, first);
+        for (size_t i = 1; i < first.size(); i++)
+        {
+            // Walk back over the run of equal hashes; it is nearly always a single entry.
+            for (size_t j = i; j-- > 0 && first[j].first == first[i].first;)
+            {
+                if (std::invoke(genome_of, population[first[j].second]) == std::invoke(genome_of, population[first[i].second]))
+                {
+                    duplicates.push_back(first[i].second);
+                    break;
+                }
+            }
+        }
+        std::sort(duplicates.begin(), duplicates.end());
+    }
+
+    /**
+     * @brief Count the distinct genomes in a population.
+     */
+    template <typename Range, typename GenomeOf>
+    size_t count_distinct(const Range &population, GenomeOf genome_of)
+    {
+        find_duplicates(population, genome_of, this->duplicates);
+        return population.size() - this->duplicates.size();
+    }
+};
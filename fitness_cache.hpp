@@ -0,0 +1,120 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <span>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+#include "bitstring.hpp"
+
+/**
+ * A bounded, thread-safe map from genomes to objective function values.
+ * Only valid for deterministic objectives: a hit returns the value of an
+ * earlier evaluation of the same genome. The table is direct-mapped on the
+ * genome hash, so a new genome simply replaces whatever occupied its slot,
+ * and memory stays at capacity entries. Entries store the full genome words,
+ * so hash collisions are detected and never return a wrong value. Slots are
+ * guarded by a fixed set of striped locks, so one cache can be shared by all
+ * threads and runs of an experiment on the same objective and geometry.
+ */
+class FitnessCache
+{
+private:
+    struct Entry
+    {
+        uint64_t hash = 0;
+        bool used = false;
+        double objective = 0.0;
+    };
+
+    static constexpr size_t lock_count = 64;
+
+    size_t word_count;
+    std::vector<Entry> entries;
+    // The genome of entry i is words[i * word_count, (i + 1) * word_count).
+    std::vector<uint64_t> words;
+    std::array<std::mutex, lock_count> locks;
+    std::atomic<uint64_t> hit_count = 0;
+    std::atomic<uint64_t> miss_count = 0;
+
+    size_t slot_of(uint64_t hash) const
+    {
+        // The hash is already mixed; reduce it to the table without a division.
+        return (size_t)(((rng::uint128)hash * this->entries.size()) >> 64);
+    }
+
+    std::span<uint64_t> words_of(size_t slot)
+    {
+        return std::span(this->words).subspan(slot * this->word_count, this->word_count);
+    }
+
+public:
+    /**
+     * @brief Create an empty cache.
+     * @param bits The genome length in bits.
+     * @param capacity The maximum number of genomes kept.
+     */
+    FitnessCache(size_t bits, size_t capacity) : word_count(bitops::words_for(bits)),
+                                                 entries(capacity),
+                                                 words(capacity * bitops::words_for(bits))
+    {
+        assert(capacity > 0);
+    }
+
+    /**
+     * @brief Look a genome up.
+     * @param genome The genome (bitstring or StaticGenome).
+     * @return The cached objective function value, if the genome is cached.
+     */
+    template <typename Genome>
+    std::optional<double> find(const Genome &genome)
+    {
+        auto genome_words = genome.get_words();
+        assert(genome_words.size() == this->word_count);
+        auto slot = slot_of(genome.hash());
+        {
+            std::lock_guard lock(this->locks[slot % lock_count]);
+            const auto &entry = this->entries[slot];
+            if (entry.used && entry.hash == genome.hash() && std::ranges::equal(words_of(slot), genome_words))
+            {
+                this->hit_count.fetch_add(1, std::memory_order_relaxed);
+                return entry.objective;
+            }
+        }
+        this->miss_count.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Store the objective function value of a genome, replacing the slot's previous genome.
+     */
+    template <typename Genome>
+    void insert(const Genome &genome, double objective)
+    {
+        auto genome_words = genome.get_words();
+        assert(genome_words.size() == this->word_count);
+        auto slot = slot_of(genome.hash());
+        std::lock_guard lock(this->locks[slot % lock_count]);
+        auto &entry = this->entries[slot];
+        entry.hash = genome.hash();
+        entry.used = true;
+        entry.objective = objective;
+        std::ranges::copy(genome_words, words_of(slot).begin());
+    }
+
+    uint64_t hits() const { return this->hit_count.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return this->miss_count.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the fraction of lookups that were hits, 0 before any lookup.
+     */
+    double hit_rate() const
+    {
+        auto lookups = hits() + misses();
+        return lookups == 0 ? 0.0 : (double)hits() / (double)lookups;
+    }
+};
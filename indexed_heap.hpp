@@ -0,0 +1,121 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <utility>
+#include <cassert>
+
+/**
+ * A binary heap over the indices 0..n-1 of a key array, with the position
+ * of every index tracked so a single key can be changed in O(log n).
+ * The top is the index with the highest key (or lowest, for a min-heap);
+ * ties go to the lowest index, as std::max_element and std::min_element
+ * would find them. Storage is reused between reset() calls.
+ */
+class IndexedHeap
+{
+private:
+    bool highest_first;
+    std::vector<double> keys;
+    std::vector<size_t> heap;
+    // position[i] is the place of index i in heap.
+    std::vector<size_t> position;
+
+    bool before(size_t a, size_t b) const
+    {
+        if (this->keys[a] != this->keys[b])
+        {
+            return this->highest_first ? this->keys[a] > this->keys[b] : this->keys[a] < this->keys[b];
+        }
+        return a < b;
+    }
+
+    void place(size_t at, size_t index)
+    {
+        this->heap[at] = index;
+        this->position[index] = at;
+    }
+
+    void sift_up(size_t at)
+    {
+        auto index = this->heap[at];
+        while (at > 0 && before(index, this->heap[(at - 1) / 2]))
+        {
+            place(at, this->heap[(at - 1) / 2]);
+            at = (at - 1) / 2;
+        }
+        place(at, index);
+    }
+
+    void sift_down(size_t at)
+    {
+        auto index = this->heap[at];
+        auto n = this->heap.size();
+        while (2 * at + 1 < n)
+        {
+            auto child = 2 * at + 1;
+            if (child + 1 < n && before(this->heap[child + 1], this->heap[child]))
+            {
+                child++;
+            }
+            if (!before(this->heap[child], index))
+            {
+                break;
+            }
+            place(at, this->heap[child]);
+            at = child;
+        }
+        place(at, index);
+    }
+
+public:
+    explicit IndexedHeap(bool highest_first) : highest_first(highest_first) {}
+
+    /**
+     * @brief Build the heap over a copy of keys, in O(n).
+     */
+    void reset(std::span<const double> values)
+    {
+        this->keys.assign(values.begin(), values.end());
+        this->heap.resize(values.size());
+        this->position.resize(values.size());
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            place(i, i);
+        }
+        for (auto at = values.size() / 2; at-- > 0;)
+        {
+            sift_down(at);
+        }
+    }
+
+    size_t size() const { return this->heap.size(); }
+
+    /**
+     * @brief Get the index with the highest (lowest) key.
+     */
+    size_t top() const
+    {
+        assert(!this->heap.empty());
+        return this->heap[0];
+    }
+
+    double key(size_t index) const { return this->keys[index]; }
+
+    /**
+     * @brief Change the key of one index and restore the heap order.
+     */
+    void update(size_t index, double value)
+    {
+        assert(index < this->keys.size());
+        this->keys[index] = value;
+        auto at = this->position[index];
+        if (at > 0 && before(index, this->heap[(at - 1) / 2]))
+        {
+            sift_up(at);
+        }
+        else
+        {
+            sift_down(at);
+        }
+    }
+};
@@ -0,0 +1,202 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <mutex>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+#include <ostream>
+#include <cassert>
+
+#include "parallel.hpp"
+
+/**
+ * Runs independent jobs of very different lengths, such as the runs of an
+ * experiment, over a team of OpenMP threads (workers).
+ * Every job comes with an estimated cost. The jobs are sorted longest first
+ * and dealt round-robin to per-worker queues. A worker runs its own queue
+ * from the front and, once it is empty, steals the longest job left in any
+ * other queue, so the long jobs start early and the short ones fill the
+ * gaps at the end. Which worker runs a job never changes its result.
+ * Every worker keeps statistics on the jobs it ran and the time it spent
+ * in them, for checking how well a schedule kept the cores busy.
+ */
+class JobScheduler
+{
+public:
+    struct WorkerStatistics
+    {
+        // The jobs the worker ran, and how many of them it stole.
+        size_t jobs = 0;
+        size_t stolen = 0;
+        // The summed estimated cost of the jobs.
+        double cost = 0.0;
+        // The time spent in the jobs.
+        std::chrono::steady_clock::duration busy{};
+    };
+
+private:
+    struct alignas(64) Queue
+    {
+        std::mutex mutex;
+        // Job indices, longest first; [front, back) are not taken yet.
+        std::vector<size_t> jobs;
+        size_t front = 0;
+        size_t back = 0;
+    };
+
+    size_t workers;
+    std::vector<Queue> queues;
+    std::vector<WorkerStatistics> statistics;
+    std::chrono::steady_clock::duration elapsed{};
+
+    /**
+     * @brief Take the next job of a worker: the front of its own queue, or else the longest left elsewhere.
+     * @return The job index, or costs.size() once every queue is empty.
+     */
+    size_t take(size_t worker, std::span<const double> costs)
+    {
+        {
+            auto &own = this->queues[worker];
+            std::lock_guard lock(own.mutex);
+            if (own.front < own.back)
+            {
+                return own.jobs[own.front++];
+            }
+        }
+        while (true)
+        {
+            auto victim = this->workers;
+            auto longest = -1.0;
+            for (size_t other = 0; other < this->workers; other++)
+            {
+                auto &queue = this->queues[other];
+                std::lock_guard lock(queue.mutex);
+                if (queue.front < queue.back && costs[queue.jobs[queue.front]] > longest)
+                {
+                    victim = other;
+                    longest = costs[queue.jobs[queue.front]];
+                }
+            }
+            if (victim == this->workers)
+            {
+                return costs.size();
+            }
+            auto &queue = this->queues[victim];
+            std::lock_guard lock(queue.mutex);
+            // Another thief may have emptied the queue since the scan.
+            if (queue.front < queue.back)
+            {
+                this->statistics[worker].stolen++;
+                return queue.jobs[queue.front++];
+            }
+        }
+    }
+
+public:
+    /**
+     * @param worker_count The number of workers, all OpenMP threads by default.
+     */
+    explicit JobScheduler(size_t worker_count = parallel::threads_per_job(1)) : workers(worker_count),
+                                                                               queues(worker_count),
+                                                                               statistics(worker_count)
+    {
+        assert(worker_count > 0);
+    }
+
+    /**
+     * @brief Estimate the cost of a GA run: the bits it breeds over all generations.
+     */
+    static double run_cost(size_t pop_size, size_t num_of_gens, size_t genome_bits)
+    {
+        return (double)pop_size * (double)num_of_gens * (double)genome_bits;
+    }
+
+    /**
+     * @brief Run every job once and wait for all of them.
+     * Statistics are those of this call only.
+     * @param costs The estimated cost of every job; only their ratios matter.
+     * @param job Called as job(index) for every index of costs, from the workers.
+     */
+    template <typename Job>
+    void run(std::span<const double> costs, Job &&job)
+    {
+        std::vector<size_t> order(costs.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::sort(order, [&](size_t a, size_t b)
+                          { return costs[a] != costs[b] ? costs[a] > costs[b] : a < b; });
+        for (size_t worker = 0; worker < this->workers; worker++)
+        {
+            auto &queue = this->queues[worker];
+            queue.jobs.clear();
+            for (auto k = worker; k < order.size(); k += this->workers)
+            {
+                queue.jobs.push_back(order[k]);
+            }
+            queue.front = 0;
+            queue.back = queue.jobs.size();
+            this->statistics[worker] = {};
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        // A smaller team than asked for still runs every job, by stealing from the absent workers.
+#pragma omp parallel num_threads((int)this->workers) if (this->workers > 1)
+        {
+            auto worker = (size_t)omp_get_thread_num();
+            auto &statistics = this->statistics[worker];
+            for (auto index = take(worker, costs); index < costs.size(); index = take(worker, costs))
+            {
+                auto job_started = std::chrono::steady_clock::now();
+                job(index);
+                statistics.busy += std::chrono::steady_clock::now() - job_started;
+                statistics.jobs++;
+                statistics.cost += costs[index];
+            }
+        }
+        this->elapsed = std::chrono::steady_clock::now() - started;
+    }
+
+    size_t get_workers() const { return this->workers; }
+
+    /**
+     * @brief Get the statistics of every worker from the last run().
+     */
+    const std::vector<WorkerStatistics> &get_statistics() const { return this->statistics; }
+
+    /**
+     * @brief Get the wall-clock time of the last run().
+     */
+    std::chrono::steady_clock::duration get_elapsed() const { return this->elapsed; }
+
+    /**
+     * @brief Get the share of the workers' time the last run() spent in jobs, between 0 and 1.
+     */
+    double utilization() const
+    {
+        if (this->elapsed.count() == 0)
+        {
+            return 1.0;
+        }
+        std::chrono::steady_clock::duration busy{};
+        for (const auto &statistics : this->statistics)
+        {
+            busy += statistics.busy;
+        }
+        return std::chrono::duration<double>(busy).count() / (std::chrono::duration<double>(this->elapsed).count() * (double)this->workers);
+    }
+
+    /**
+     * @brief Write one line of statistics per worker of the last run().
+     */
+    void report(std::ostream &out) const
+    {
+        auto elapsed_seconds = std::chrono::duration<double>(this->elapsed).count();
+        for (size_t worker = 0; worker < this->workers; worker++)
+        {
+            const auto &statistics = this->statistics[worker];
+            auto busy_seconds = std::chrono::duration<double>(statistics.busy).count();
+            out << "Worker " << worker << ": " << statistics.jobs << " jobs (" << statistics.stolen << " stolen), busy "
+                << busy_seconds << " s of " << elapsed_seconds << " s" << std::endl;
+        }
+    }
+};
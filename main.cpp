@@ -1,62 +1,90 @@
 #include "main.hpp"
 
-void parameter_search()
+void parameter_search(uint64_t seed)
 {
     auto dejong1 = dejong::DeJong1();
     auto dejong2 = dejong::DeJong2();
     auto dejong3 = dejong::DeJong3();
     auto dejong4 = dejong::DeJong4();
     auto dejong5 = dejong::DeJong5();
-    random_parameter_search(50, 100, 0.7, 0.001, 32, 3, dejong1, 1000, "dejong1.csv");
-    random_parameter_search(50, 100, 0.7, 0.001, 32, 2, dejong2, 1000, "dejong2.csv");
-    random_parameter_search(50, 100, 0.7, 0.001, 32, 5, dejong3, 1000, "dejong3.csv");
-    random_parameter_search(50, 100, 0.7, 0.001, 32, 10, dejong4, 1000, "dejong4.csv");
-    random_parameter_search(50, 100, 0.7, 0.001, 32, 2, dejong5, 1000, "dejong5.csv");
+    // A run is over once it has found the optimum or stopped improving.
+    StoppingCriteria stopping;
+    stopping.target_epsilon = 1e-6;
+    stopping.stagnation_generations = 30;
+    racing_parameter_search(50, 100, 0.7, 0.001, 32, 3, dejong1, 1000, "dejong1.csv", seed, stopping, 7, 4);
+    racing_parameter_search(50, 100, 0.7, 0.001, 32, 2, dejong2, 1000, "dejong2.csv", seed, stopping, 7, 4);
+    racing_parameter_search(50, 100, 0.7, 0.001, 32, 5, dejong3, 1000, "dejong3.csv", seed, stopping, 7, 4);
+    racing_parameter_search(50, 100, 0.7, 0.001, 32, 10, dejong4, 1000, "dejong4.csv", seed, stopping, 7, 4);
+    racing_parameter_search(50, 100, 0.7, 0.001, 32, 2, dejong5, 1000, "dejong5.csv", seed, stopping, 7, 4);
 }
 
-void GAPerformance()
+// The SimpleGA runs with the parameters that performed best in the parameter search.
+std::vector<Experiment> GAPerformance()
 {
-    auto dejong1 = dejong::DeJong1();
-    auto dejong2 = dejong::DeJong2();
-    auto dejong3 = dejong::DeJong3();
-    auto dejong4 = dejong::DeJong4();
-    auto dejong5 = dejong::DeJong5();
-    run_simple_ga(180, 130, 0.66, 0.0064, 32, 3, dejong1, 30, "ga_performance_dejong1.csv");
-    run_simple_ga(130, 170, 0.6, 0.001, 32, 2, dejong2, 30, "ga_performance_dejong2.csv");
-    run_simple_ga(140, 140, 0.1085, 0.0025, 32, 5, dejong3, 30, "ga_performance_dejong3.csv");
-    run_simple_ga(180, 100, 0.68, 0.058, 32, 10, dejong4, 30, "ga_performance_dejong4.csv");
-    run_simple_ga(60, 30, 0.013, 0.0028, 32, 2, dejong5, 30, "ga_performance_dejong5.csv");
+    return {
+        {ExperimentAlgorithm::simple_ga, find_function("dejong1"), 180, 130, 0.66, 0.0064, 32, 3, 30, "ga_performance_dejong1.csv"},
+        {ExperimentAlgorithm::simple_ga, find_function("dejong2"), 130, 170, 0.6, 0.001, 32, 2, 30, "ga_performance_dejong2.csv"},
+        {ExperimentAlgorithm::simple_ga, find_function("dejong3"), 140, 140, 0.1085, 0.0025, 32, 5, 30, "ga_performance_dejong3.csv"},
+        {ExperimentAlgorithm::simple_ga, find_function("dejong4"), 180, 100, 0.68, 0.058, 32, 10, 30, "ga_performance_dejong4.csv"},
+        {ExperimentAlgorithm::simple_ga, find_function("dejong5"), 60, 30, 0.013, 0.0028, 32, 2, 30, "ga_performance_dejong5.csv"}};
 }
 
-void CHCPerformance()
+std::vector<Experiment> CHCPerformance()
 {
-    auto dejong1 = dejong::DeJong1();
-    auto dejong2 = dejong::DeJong2();
-    auto dejong3 = dejong::DeJong3();
-    auto dejong4 = dejong::DeJong4();
-    auto dejong5 = dejong::DeJong5();
-    run_chc(50, 75, 0.95, 0.05, 32, 3, dejong1, 30, "chc_performance_dejong1.csv");
-    run_chc(50, 75, 0.95, 0.05, 32, 2, dejong2, 30, "chc_performance_dejong2.csv");
-    run_chc(50, 75, 0.95, 0.05, 32, 5, dejong3, 30, "chc_performance_dejong3.csv");
-    run_chc(50, 75, 0.95, 0.05, 32, 10, dejong4, 30, "chc_performance_dejong4.csv");
-    run_chc(50, 75, 0.95, 0.05, 32, 2, dejong5, 30, "chc_performance_dejong5.csv");
+    return {
+        {ExperimentAlgorithm::chc, find_function("dejong1"), 50, 75, 0.95, 0.05, 32, 3, 30, "chc_performance_dejong1.csv"},
+        {ExperimentAlgorithm::chc, find_function("dejong2"), 50, 75, 0.95, 0.05, 32, 2, 30, "chc_performance_dejong2.csv"},
+        {ExperimentAlgorithm::chc, find_function("dejong3"), 50, 75, 0.95, 0.05, 32, 5, 30, "chc_performance_dejong3.csv"},
+        {ExperimentAlgorithm::chc, find_function("dejong4"), 50, 75, 0.95, 0.05, 32, 10, 30, "chc_performance_dejong4.csv"},
+        {ExperimentAlgorithm::chc, find_function("dejong5"), 50, 75, 0.95, 0.05, 32, 2, 30, "chc_performance_dejong5.csv"}};
 }
 
 int main(int argc, char **argv)
 {
-    if (argc == 2)
+    // The experiments mode takes the experiment file before the seed.
+    auto seed_argument = argc > 1 && strcmp(argv[1], "experiments") == 0 ? 3 : 2;
+    auto valid = argc == seed_argument || argc == seed_argument + 1;
+    // Every random draw derives from this seed; pass it again to replay the experiment.
+    uint64_t seed = 0;
+    if (valid && argc == seed_argument + 1)
     {
+        auto text = std::string_view(argv[seed_argument]);
+        auto [last, error] = std::from_chars(text.data(), text.data() + text.size(), seed);
+        valid = error == std::errc() && last == text.data() + text.size();
+    }
+    else if (valid)
+    {
+        seed = rng::random_seed();
+    }
+    if (valid)
+    {
+        std::cout << "Seed: " << seed << std::endl;
         if (strcmp(argv[1], "parameter_search") == 0)
         {
-            parameter_search();
+            parameter_search(seed);
         }
         else if (strcmp(argv[1], "ga_performance") == 0)
         {
-            GAPerformance();
+            run_experiments(GAPerformance(), seed);
         }
         else if (strcmp(argv[1], "chc_performance") == 0)
         {
-            CHCPerformance();
+            run_experiments(CHCPerformance(), seed);
+        }
+        else if (strcmp(argv[1], "performance") == 0)
+        {
+            // Both suites share one pool of runs.
+            auto experiments = GAPerformance();
+            std::ranges::move(CHCPerformance(), std::back_inserter(experiments));
+            run_experiments(experiments, seed);
+        }
+        else if (strcmp(argv[1], "experiments") == 0)
+        {
+            std::vector<Experiment> experiments;
+            if (read_experiments(argv[2], experiments))
+            {
+                run_experiments(experiments, seed);
+            }
         }
         else
         {
@@ -65,8 +93,9 @@ int main(int argc, char **argv)
     }
     else
     {
-        std::cout << "Invalid number of arguments" << std::endl;
-        std::cout << "Usage: " << argv[0] << " <parameter_search|ga_performance|chc_performance> "  << std::endl;
+        std::cout << "Invalid arguments" << std::endl;
+        std::cout << "Usage: " << argv[0] << " <parameter_search|ga_performance|chc_performance|performance> [seed]" << std::endl;
+        std::cout << "       " << argv[0] << " experiments <file> [seed]" << std::endl;
     }
     return 0;
-}
\ No newline at end of file
+}
@@ -12,6 +12,8 @@
 #include <span>
 #include <bitset>
 #include <cstring>
+#include <charconv>
+#include <string_view>
 
 // --------------------
 // Custom header includes.
@@ -20,6 +22,8 @@
 #include "Functions/dejong.hpp"
 #include "bitstring.hpp"
 #include "util.hpp"
+#include "stopping.hpp"
+#include "experiment.hpp"
 
 // --------------------
 // Third-party library includes.
@@ -48,6 +52,4 @@ const auto _EPSILON = std::numeric_limits<double>::epsilon();
 // --------------------
 // Function declarations
 // --------------------
-extern void random_parameter_search(size_t population_size, size_t num_of_generations, double crossover_prob, double mutation_prob, size_t chromosome_size, size_t number_of_chromosomes, OptimizationFunction &function, size_t num_of_runs, std::string filename);
-extern void run_simple_ga(size_t population_size, size_t num_of_generations, double crossover_prob, double mutation_prob, size_t chromosome_size, size_t number_of_chromosomes, OptimizationFunction &function, size_t num_of_runs, std::string filename);
-extern void run_chc(size_t population_size, size_t num_of_generations, double crossover_prob, double mutation_prob, size_t chromosome_size, size_t number_of_chromosomes, OptimizationFunction &function, size_t num_of_runs, std::string filename);
+extern void racing_parameter_search(size_t population_size, size_t num_of_generations, double crossover_prob, double mutation_prob, size_t chromosome_size, size_t number_of_chromosomes, OptimizationFunction &function, size_t num_of_runs, std::string filename, uint64_t seed, const StoppingCriteria &stopping, size_t rungs, size_t repetitions);
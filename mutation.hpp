@@ -0,0 +1,83 @@
+#pragma once
+#include <span>
+#include <random>
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+
+#include "bitstring.hpp"
+
+#include "random.hpp"
+
+/**
+ * Bit-flip mutation that only draws the positions that actually flip.
+ * Flipping every bit independently with probability p is the same as
+ * walking the bits with gaps drawn from a geometric distribution (the number
+ * of failures before the next success), so one random draw is made per
+ * flipped bit instead of one per bit.
+ * Drawing does not modify the object, so one instance can be shared by
+ * threads that each use their own generator.
+ */
+class GeometricMutation
+{
+private:
+    double mutation_prob;
+    // log(1 - p), the scale of the inverse-transform geometric draw.
+    double log_q;
+
+public:
+    explicit GeometricMutation(double mutation_prob) : mutation_prob(mutation_prob),
+                                                       log_q(std::log1p(-(mutation_prob > 0.0 && mutation_prob < 1.0 ? mutation_prob : 0.5)))
+    {
+        assert(mutation_prob >= 0.0 && mutation_prob <= 1.0);
+    }
+
+    /**
+     * @brief Call visit with the index of every bit chosen for mutation, in increasing order.
+     * @param bits The number of bits to walk.
+     * @param visit Called once per chosen index.
+     * @return The number of chosen bits.
+     */
+    template <typename Visit>
+    size_t for_each_position(size_t bits, Visit &&visit) const
+    {
+        if (this->mutation_prob <= 0.0)
+        {
+            return 0;
+        }
+        if (this->mutation_prob >= 1.0)
+        {
+            for (size_t i = 0; i < bits; i++)
+            {
+                visit(i);
+            }
+            return bits;
+        }
+        auto &generator = get_generator();
+        size_t count = 0;
+        for (size_t i = 0; i < bits; i++, count++)
+        {
+            // Inverse transform: floor(log(U) / log(1 - p)) with U in (0, 1].
+            auto skip = std::floor(std::log1p(-generator.uniform()) / this->log_q);
+            if (skip >= (double)(bits - i))
+            {
+                break;
+            }
+            i += (size_t)skip;
+            visit(i);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Mutate a packed genome in place.
+     * @param genome The genome (bitstring or StaticGenome).
+     * @return The number of flipped bits.
+     */
+    template <typename Genome>
+    size_t apply(Genome &genome) const
+    {
+        return for_each_position(genome.size(), [&](size_t index)
+                                 { genome.flip(index); });
+    }
+};
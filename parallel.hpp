@@ -0,0 +1,77 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+
+#include "omp.h"
+
+/**
+ * Helpers for splitting work inside a single run across OpenMP threads
+ * while the drivers already run several runs in parallel.
+ */
+namespace parallel
+{
+    /**
+     * @brief Get the number of threads each of a number of concurrent jobs may use.
+     * The product never exceeds the OpenMP thread budget, so nesting intra-run
+     * parallelism inside the run-level loop does not oversubscribe the cores.
+     * @param jobs The number of jobs that will run at the same time.
+     */
+    inline size_t threads_per_job(size_t jobs)
+    {
+        auto total = (size_t)std::max(1, omp_get_max_threads());
+        return std::max<size_t>(1, total / std::max<size_t>(1, jobs));
+    }
+
+    /**
+     * @brief Allow a parallel region inside the run-level parallel loop.
+     */
+    inline void enable_nesting()
+    {
+        if (omp_get_max_active_levels() < 2)
+        {
+            omp_set_max_active_levels(2);
+        }
+    }
+
+    /**
+     * @brief Split [0, n) into at most threads contiguous chunks and run them in parallel.
+     * Every chunk has its own index, so per-chunk scratch state can be indexed
+     * by it without sharing. With one thread no parallel team is started.
+     * @param n The number of items.
+     * @param threads The number of threads to use.
+     * @param body Called as body(begin, end, chunk).
+     */
+    template <typename Body>
+    void for_each_chunk(size_t n, size_t threads, Body &&body)
+    {
+        auto chunks = std::max<size_t>(1, std::min(threads, n));
+#pragma omp parallel for num_threads((int)chunks) if (chunks > 1) schedule(static, 1)
+        for (size_t chunk = 0; chunk < chunks; chunk++)
+        {
+            body(n * chunk / chunks, n * (chunk + 1) / chunks, chunk);
+        }
+    }
+
+    /**
+     * @brief Split [0, n) into fixed blocks and run contiguous runs of blocks in parallel.
+     * Unlike for_each_chunk, where the work is cut depends only on n and
+     * block_size, not on the thread count, so per-block results (e.g. partial
+     * sums) are the same for any number of threads.
+     * @param n The number of items.
+     * @param block_size The number of items per block (the last may be shorter).
+     * @param threads The number of threads to use.
+     * @param body Called as body(begin, end, chunk) once per block; chunk identifies
+     * the thread's share of the blocks, for indexing scratch state.
+     */
+    template <typename Body>
+    void for_each_block(size_t n, size_t block_size, size_t threads, Body &&body)
+    {
+        auto blocks = (n + block_size - 1) / block_size;
+        for_each_chunk(blocks, threads, [&](size_t first, size_t last, size_t chunk)
+                       {
+            for (size_t block = first; block < last; block++)
+            {
+                body(block * block_size, std::min(n, (block + 1) * block_size), chunk);
+            } });
+    }
+}
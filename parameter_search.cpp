@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <numeric>
@@ -6,14 +8,57 @@
 
 #include "Functions/function.hpp"
 #include "Functions/dejong.hpp"
-#include "Algorithms/simple_ga.hpp"
+#include "Algorithms/engine_factory.hpp"
 
-extern std::mt19937 &get_generator();
+#include "random.hpp"
+#include "job_scheduler.hpp"
 
-// Function to perform a random parameter search on the SimpleGA algorithm.
-// The results are written to a file.
-void random_parameter_search(size_t population_size, size_t num_of_generations, double crossover_prob, double mutation_prob, size_t chromosome_size, size_t number_of_chromosomes, OptimizationFunction &function, size_t num_of_runs, std::string filename)
+namespace
 {
+    // A configuration in the race and its runs at the last budget it was given.
+    struct Candidate
+    {
+        size_t population_size;
+        size_t num_of_generations;
+        double crossover_prob;
+        double mutation_prob;
+        // The generations the runs below were given.
+        size_t budget_generations = 0;
+        // The best fitness and best solution of every repetition run so far.
+        std::vector<double> fitness;
+        std::vector<std::vector<double>> solutions;
+        // The mean best fitness of the repetitions.
+        double score = 0.0;
+    };
+
+    // One run of a candidate: the candidate and the repetition.
+    struct Job
+    {
+        size_t candidate;
+        size_t repetition;
+    };
+}
+
+// Function to perform a racing (successive halving) parameter search on the
+// SimpleGA algorithm. The results are written to a file.
+// Every configuration starts with a small budget, and each rung keeps the
+// better half for a budget twice as large. The budget of a rung is counted
+// in full runs: below one it is that fraction of the configuration's
+// generations, from one on it is that many repeated full runs, so that the
+// last rungs average over several seeds. Every rung costs about as much as
+// the first, and the last gives each survivor `repetitions` full runs.
+// Runs end early once they meet the stopping criteria; their best is that
+// of the generation they stopped at.
+// The file has one row per configuration, with the mean best fitness of
+// the repetitions at the last rung it reached, the best solution of the
+// best of those runs and the configuration's parameters, then the
+// generations those runs were given and how many there were.
+void racing_parameter_search(size_t population_size, size_t num_of_generations, double crossover_prob, double mutation_prob, size_t chromosome_size, size_t number_of_chromosomes, OptimizationFunction &function, size_t num_of_runs, std::string filename, uint64_t seed, const StoppingCriteria &stopping, size_t rungs, size_t repetitions)
+{
+    assert(num_of_runs > 0);
+    assert(rungs > 0);
+    assert(repetitions > 0);
+
     // Open the file and write the header.
     std::ofstream file;
     file.open(filename, std::ios::out | std::ios::trunc);
@@ -22,7 +67,7 @@ void random_parameter_search(size_t population_size, size_t num_of_generations,
         std::cout << "Could not open file " << filename << std::endl;
         return;
     }
-    file << "Run,Best Fitness,Best Value,Population Size,Generations,Crossover Prob., Mutation Prob." << std::endl;
+    file << "Run,Best Fitness,Best Value,Population Size,Generations,Crossover Prob., Mutation Prob.,Rung Generations,Repetitions" << std::endl;
 
     // Set up the random number distributions.
     std::uniform_int_distribution<int> population_size_dist(10, 200);
@@ -30,42 +75,107 @@ void random_parameter_search(size_t population_size, size_t num_of_generations,
     std::uniform_real_distribution<double> crossover_dist(0.0, 1.0);
     std::uniform_real_distribution<double> mutation_dist(0.0, 0.1);
 
-// Run the algorithm num_of_runs times.
-// If i == 0, use the parameters passed to the function.
-// Otherwise, generate random parameters.
-// Write the results to the file.
-// Uses OpenMP to parallelize the runs.
-#pragma omp parallel for
+    // Candidate 0 uses the parameters passed to the function.
+    // The others draw their parameters from their own streams, under a seed
+    // derived from the file name so every search draws its own configurations.
+    auto parameter_seed = rng::derive_seed(seed, filename);
+    std::vector<Candidate> candidates(num_of_runs);
     for (size_t i = 0; i < num_of_runs; i++)
     {
-        auto internal_population_size = population_size;
-        auto internal_num_of_generations = num_of_generations;
-        auto internal_crossover_prob = crossover_prob;
-        auto internal_mutation_prob = mutation_prob;
+        auto &candidate = candidates[i];
+        candidate.population_size = population_size;
+        candidate.num_of_generations = num_of_generations;
+        candidate.crossover_prob = crossover_prob;
+        candidate.mutation_prob = mutation_prob;
         if (i != 0)
         {
-            internal_population_size = (size_t)population_size_dist(get_generator());
-            internal_num_of_generations = (size_t)generations_dist(get_generator());
-            internal_crossover_prob = crossover_dist(get_generator());
-            internal_mutation_prob = mutation_dist(get_generator());
+            rng::Stream parameters(parameter_seed, rng::Phase::parameters, i, 0, 0);
+            candidate.population_size = (size_t)population_size_dist(parameters);
+            candidate.num_of_generations = (size_t)generations_dist(parameters);
+            candidate.crossover_prob = crossover_dist(parameters);
+            candidate.mutation_prob = mutation_dist(parameters);
         }
-        std::cout << "Run " << i << " of " << num_of_runs - 1 << std::endl;
-        auto algorithm = SimpleGA(internal_population_size, internal_num_of_generations, internal_crossover_prob, internal_mutation_prob, chromosome_size, number_of_chromosomes, function);
+    }
+
+    std::vector<size_t> alive(num_of_runs);
+    std::iota(alive.begin(), alive.end(), 0);
+    std::vector<Job> jobs;
+    std::vector<double> costs;
+    JobScheduler scheduler;
+    for (size_t rung = 0; rung < rungs; rung++)
+    {
+        auto budget = (double)repetitions * std::ldexp(1.0, (int)rung - (int)(rungs - 1));
+        auto fraction = std::min(budget, 1.0);
+        auto runs_per_candidate = std::max((size_t)budget, (size_t)1);
 
-        auto performance = algorithm.run();
-        auto best_fitness = performance.back().best_fitness;
-        auto best_x = performance.back().best_solution;
-// Write the results to the file.
-// Has to be within this critical block to prevent race conditions.
-#pragma omp critical
+        // Queue the runs the rung still needs; a full run of an earlier rung is kept.
+        jobs.clear();
+        for (auto i : alive)
         {
-            file << i << "," << best_fitness << ",( ";
-            for (auto &x : best_x)
+            auto &candidate = candidates[i];
+            auto generations = std::max((size_t)std::ceil((double)candidate.num_of_generations * fraction), (size_t)1);
+            if (candidate.budget_generations != generations)
             {
-                file << x << " ";
+                candidate.budget_generations = generations;
+                candidate.fitness.clear();
+                candidate.solutions.clear();
             }
-            file << ")," << internal_population_size << "," << internal_num_of_generations << "," << internal_crossover_prob << "," << internal_mutation_prob << std::endl;
+            for (auto repetition = candidate.fitness.size(); repetition < runs_per_candidate; repetition++)
+            {
+                jobs.push_back({i, repetition});
+            }
+            candidate.fitness.resize(runs_per_candidate);
+            candidate.solutions.resize(runs_per_candidate);
+        }
+        // Configurations differ in cost by up to 400x, so the longest runs go first.
+        costs.clear();
+        for (const auto &job : jobs)
+        {
+            const auto &candidate = candidates[job.candidate];
+            costs.push_back(JobScheduler::run_cost(candidate.population_size, candidate.budget_generations, chromosome_size * number_of_chromosomes));
+        }
+        // Every run writes its own slot of its candidate.
+        scheduler.run(costs, [&](size_t j)
+                      {
+            auto [i, repetition] = jobs[j];
+            auto &candidate = candidates[i];
+            auto algorithm = make_simple_ga(candidate.population_size, candidate.budget_generations, candidate.crossover_prob, candidate.mutation_prob, chromosome_size, number_of_chromosomes, function);
+            // Repetition 0 of a candidate is the run a single search of it would make.
+            algorithm->set_seed(seed, repetition * num_of_runs + i);
+            algorithm->set_stopping_criteria(stopping);
+            auto performance = algorithm->run();
+            candidate.fitness[repetition] = performance.back().best_fitness;
+            candidate.solutions[repetition] = std::move(performance.back().best_solution); });
+        std::cout << "Rung " << rung << ": " << alive.size() << " configurations, " << jobs.size() << " runs, "
+                  << (int)std::round(100.0 * scheduler.utilization()) << "% utilization" << std::endl;
+
+        for (auto i : alive)
+        {
+            auto &candidate = candidates[i];
+            candidate.score = std::accumulate(candidate.fitness.begin(), candidate.fitness.end(), 0.0) / (double)candidate.fitness.size();
+        }
+        // Keep the better half; ties go to the lower run.
+        std::ranges::sort(alive, [&](size_t a, size_t b)
+                          { return candidates[a].score != candidates[b].score ? candidates[a].score > candidates[b].score : a < b; });
+        if (rung + 1 < rungs)
+        {
+            alive.resize((alive.size() + 1) / 2);
+        }
+    }
+    std::cout << "Best: run " << alive.front() << " with mean best fitness " << candidates[alive.front()].score << std::endl;
+
+    // Write the results to the file.
+    for (size_t i = 0; i < num_of_runs; i++)
+    {
+        const auto &candidate = candidates[i];
+        auto best = (size_t)std::distance(candidate.fitness.begin(), std::ranges::max_element(candidate.fitness));
+        file << i << "," << candidate.score << ",( ";
+        for (auto &x : candidate.solutions[best])
+        {
+            file << x << " ";
         }
+        file << ")," << candidate.population_size << "," << candidate.num_of_generations << "," << candidate.crossover_prob << "," << candidate.mutation_prob
+             << "," << candidate.budget_generations << "," << candidate.fitness.size() << "\n";
     }
     file.close();
-}
\ No newline at end of file
+}
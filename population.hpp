@@ -0,0 +1,554 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+#include <algorithm>
+
+#include "Functions/function.hpp"
+#include "bitstring.hpp"
+
+#include "random.hpp"
+
+/**
+ * Allocates storage aligned to a cache line, so a population's genome
+ * words start on a line boundary.
+ */
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(size_t count)
+    {
+        return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T *pointer, size_t)
+    {
+        ::operator delete(pointer, std::align_val_t{Alignment});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+};
+
+/**
+ * What every genome of a population shares: the geometry, the encoding
+ * bounds and the objective. Stored once per population instead of once per
+ * member.
+ */
+struct GenomeSchema
+{
+    size_t variable_size;
+    size_t number_of_variables;
+    size_t bits;
+    size_t word_count;
+    double min;
+    double max;
+    // The largest value of one group, 2^variable_size - 1.
+    double full;
+    OptimizationFunction *function;
+
+    GenomeSchema(size_t variable_size, size_t number_of_variables, OptimizationFunction &function) : variable_size(variable_size),
+                                                                                                   number_of_variables(number_of_variables),
+                                                                                                   bits(variable_size * number_of_variables),
+                                                                                                   word_count(bitops::words_for(variable_size * number_of_variables)),
+                                                                                                   min(function.getXRange().first),
+                                                                                                   max(function.getXRange().second),
+                                                                                                   full(std::ldexp(1.0, (int)variable_size) - 1),
+                                                                                                   function(&function)
+    {
+        assert(variable_size > 0 && variable_size <= 64);
+        assert(number_of_variables > 0);
+        assert(min < max);
+        assert(function.getNumberOfVariables() == number_of_variables);
+    }
+
+    /**
+     * @brief Decode one group of a genome, as bitstring::decode does.
+     */
+    double decode(std::span<const uint64_t> words, size_t group) const
+    {
+        auto value = bitops::extract(words, group * this->variable_size, this->variable_size);
+        return this->min + (this->max - this->min) * ((double)value / this->full);
+    }
+};
+
+/**
+ * A view of one genome stored in a Population: its words and its hash.
+ * Offers the genome interface the operators, the cache and the fingerprint
+ * use (size, get_words, hash, flip, ...), so they work on population members
+ * in place. A mutable view keeps the member's hash up to date; it does not
+ * touch the member's evaluation, see Population::mutable_genome.
+ * @tparam Mutable Whether the genome can be modified through the view.
+ */
+template <bool Mutable>
+class BasicGenomeRef
+{
+    template <bool>
+    friend class BasicGenomeRef;
+
+    using Word = std::conditional_t<Mutable, uint64_t, const uint64_t>;
+
+    std::span<Word> words;
+    Word *hash_value;
+    size_t bits;
+
+public:
+    BasicGenomeRef(std::span<Word> words, Word *hash_value, size_t bits) : words(words), hash_value(hash_value), bits(bits) {}
+
+    // A mutable view converts to a const one.
+    template <bool OtherMutable>
+        requires(!Mutable && OtherMutable)
+    BasicGenomeRef(const BasicGenomeRef<OtherMutable> &other) : words(other.words), hash_value(other.hash_value), bits(other.bits)
+    {
+    }
+
+    size_t size() const { return this->bits; }
+
+    std::span<const uint64_t> get_words() const { return this->words; }
+
+    /**
+     * @brief Get the hash of the genome, see bitops::hash. O(1).
+     */
+    uint64_t hash() const { return *this->hash_value; }
+
+    /**
+     * @brief Compare the genomes (not the views).
+     */
+    template <bool OtherMutable>
+    bool operator==(const BasicGenomeRef<OtherMutable> &other) const
+    {
+        return this->bits == other.bits && hash() == other.hash() && std::ranges::equal(this->words, other.words);
+    }
+
+    /**
+     * @brief Get the bit at the given index.
+     */
+    uint8_t operator[](size_t index) const
+    {
+        assert(index < this->bits);
+        return (this->words[index / bitops::word_bits] & bitops::mask_of(index)) != 0;
+    }
+
+    /**
+     * @brief Count the bits that differ from another genome of the same size.
+     */
+    template <bool OtherMutable>
+    size_t hamming_distance(const BasicGenomeRef<OtherMutable> &other) const
+    {
+        assert(this->bits == other.bits);
+        return bitops::hamming_distance(this->words, other.words);
+    }
+
+    /**
+     * @brief Flip the bits of one word selected by a mask, updating the hash incrementally.
+     * @param word The index of the word.
+     * @param mask The bits to flip. Must not touch the padding bits.
+     */
+    void xor_word(size_t word, uint64_t mask)
+        requires Mutable
+    {
+        assert(word < this->words.size());
+        assert(word + 1 < this->words.size() || (mask & ~bitops::tail_mask(this->bits)) == 0);
+        auto old = this->words[word];
+        this->words[word] ^= mask;
+        *this->hash_value ^= bitops::mix(old, word) ^ bitops::mix(this->words[word], word);
+    }
+
+    /**
+     * @brief Flip the bit at the given index.
+     */
+    void flip(size_t index)
+        requires Mutable
+    {
+        assert(index < this->bits);
+        xor_word(index / bitops::word_bits, bitops::mask_of(index));
+    }
+
+    /**
+     * @brief Exchange every bit from point onwards with another genome (one-point crossover).
+     * @return Whether either genome changed.
+     */
+    bool swap_tail(BasicGenomeRef &other, size_t point)
+        requires Mutable
+    {
+        assert(this->bits == other.bits);
+        auto changed = false;
+        for (auto word = point / bitops::word_bits; word < this->words.size(); word++)
+        {
+            auto diff = this->words[word] ^ other.words[word];
+            if (word == point / bitops::word_bits)
+            {
+                diff &= ~uint64_t{0} >> (point % bitops::word_bits);
+            }
+            if (diff != 0)
+            {
+                xor_word(word, diff);
+                other.xor_word(word, diff);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    /**
+     * @brief Overwrite every bit from point onwards with the bits of another genome.
+     * One-point crossover for a child whose sibling is not kept.
+     * @return Whether the genome changed.
+     */
+    bool copy_tail(const BasicGenomeRef<false> &other, size_t point)
+        requires Mutable
+    {
+        assert(this->bits == other.bits);
+        auto changed = false;
+        for (auto word = point / bitops::word_bits; word < this->words.size(); word++)
+        {
+            auto diff = this->words[word] ^ other.words[word];
+            if (word == point / bitops::word_bits)
+            {
+                diff &= ~uint64_t{0} >> (point % bitops::word_bits);
+            }
+            if (diff != 0)
+            {
+                xor_word(word, diff);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+};
+
+using GenomeRef = BasicGenomeRef<true>;
+using ConstGenomeRef = BasicGenomeRef<false>;
+
+/**
+ * A population stored as structure of arrays.
+ * All genomes live in one contiguous, cache-line aligned arena of packed
+ * words (member i at words [i * word_count, (i + 1) * word_count)), next to
+ * parallel arrays of their hashes, fitness and objective function values.
+ * The schema is stored once. Members are addressed by index; copying a
+ * member copies a few words, and copying or swapping whole populations of
+ * the same size does not allocate.
+ */
+class Population
+{
+private:
+    GenomeSchema schema;
+    size_t count = 0;
+    std::vector<uint64_t, AlignedAllocator<uint64_t>> words;
+    std::vector<uint64_t> hashes;
+    std::vector<double> fitness_values;
+    std::vector<double> objective_values;
+    // Whether fitness and objective belong to the current genome.
+    std::vector<uint8_t> evaluated;
+    // Per-variable terms of a separable objective and the group bits they
+    // belong to (count x number_of_variables), see evaluate_terms(). Only
+    // allocated once enable_terms() has been called.
+    bool tracks_terms = false;
+    std::vector<double> terms;
+    std::vector<uint64_t> term_groups;
+    std::vector<uint8_t> has_terms;
+
+    std::span<uint64_t> words_of(size_t index)
+    {
+        assert(index < this->count);
+        return std::span(this->words).subspan(index * this->schema.word_count, this->schema.word_count);
+    }
+    std::span<const uint64_t> words_of(size_t index) const
+    {
+        assert(index < this->count);
+        return std::span(this->words).subspan(index * this->schema.word_count, this->schema.word_count);
+    }
+
+    // A mutable view that leaves the evaluation alone; callers invalidate as needed.
+    GenomeRef view(size_t index)
+    {
+        return GenomeRef(words_of(index), &this->hashes[index], this->schema.bits);
+    }
+
+public:
+    /**
+     * @brief Create a population of all-zero, unevaluated genomes.
+     * @param schema The geometry and objective of the genomes.
+     * @param size The number of members.
+     */
+    Population(const GenomeSchema &schema, size_t size = 0) : schema(schema)
+    {
+        resize(size);
+    }
+
+    /**
+     * @brief Change the number of members. New members are all-zero and unevaluated.
+     */
+    void resize(size_t size)
+    {
+        this->count = size;
+        this->words.resize(size * this->schema.word_count);
+        this->hashes.resize(size, bitops::hash(std::vector<uint64_t>(this->schema.word_count)));
+        this->fitness_values.resize(size);
+        this->objective_values.resize(size);
+        this->evaluated.resize(size);
+        if (this->tracks_terms)
+        {
+            this->terms.resize(size * this->schema.number_of_variables);
+            this->term_groups.resize(size * this->schema.number_of_variables);
+            this->has_terms.resize(size);
+        }
+    }
+
+    size_t size() const { return this->count; }
+    const GenomeSchema &get_schema() const { return this->schema; }
+
+    /**
+     * @brief Get a read-only view of a member's genome.
+     */
+    ConstGenomeRef genome(size_t index) const
+    {
+        return ConstGenomeRef(words_of(index), &this->hashes[index], this->schema.bits);
+    }
+    ConstGenomeRef operator[](size_t index) const { return genome(index); }
+
+    /**
+     * @brief Get a view of a member's genome for in-place operators.
+     * @warning Invalidates the member's evaluation.
+     */
+    GenomeRef mutable_genome(size_t index)
+    {
+        this->evaluated[index] = false;
+        return view(index);
+    }
+
+    /**
+     * @brief Fill a member's genome with random bits from the calling thread's generator.
+     */
+    void randomize(size_t index)
+    {
+        auto member = words_of(index);
+        get_generator().fill(member);
+        member.back() &= bitops::tail_mask(this->schema.bits);
+        this->hashes[index] = bitops::hash(member);
+        this->evaluated[index] = false;
+    }
+
+    /**
+     * @brief Copy a member, evaluation included, from another population (or this one).
+     * @param to The index of the member to overwrite.
+     * @param from The population to copy from; must share the schema.
+     * @param index The index of the member to copy.
+     */
+    void copy(size_t to, const Population &from, size_t index)
+    {
+        assert(from.schema.bits == this->schema.bits);
+        if (&from == this && to == index)
+        {
+            return;
+        }
+        std::ranges::copy(from.words_of(index), words_of(to).begin());
+        this->hashes[to] = from.hashes[index];
+        this->fitness_values[to] = from.fitness_values[index];
+        this->objective_values[to] = from.objective_values[index];
+        this->evaluated[to] = from.evaluated[index];
+        if (this->tracks_terms)
+        {
+            copy_terms(to, from, index);
+        }
+    }
+
+    /**
+     * @brief Bit-flip mutate a member in place.
+     * Invalidates its evaluation if any bit flipped.
+     * @param index The member.
+     * @param mutation The mutation operator, e.g. GeometricMutation.
+     * @return The number of flipped bits.
+     */
+    template <typename Mutation>
+    size_t mutate(size_t index, const Mutation &mutation)
+    {
+        auto member = view(index);
+        auto flipped = mutation.apply(member);
+        if (flipped > 0)
+        {
+            this->evaluated[index] = false;
+        }
+        return flipped;
+    }
+
+    /**
+     * @brief One-point crossover of two members in place.
+     * Invalidates their evaluations if the tails differed.
+     * @param first The first member.
+     * @param second The second member.
+     * @param point The index of the first bit to exchange.
+     */
+    void swap_tail(size_t first, size_t second, size_t point)
+    {
+        auto a = view(first), b = view(second);
+        if (a.swap_tail(b, point))
+        {
+            invalidate(first);
+            invalidate(second);
+        }
+    }
+
+    /**
+     * @brief Overwrite the tail of a member with the tail of another genome.
+     * One-point crossover for a child whose sibling is not kept. Invalidates
+     * the member's evaluation if the tails differed.
+     * @param to The member to overwrite.
+     * @param from The population holding the other genome; must share the schema.
+     * @param index The other genome's member.
+     * @param point The index of the first bit to copy.
+     */
+    void copy_tail(size_t to, const Population &from, size_t index, size_t point)
+    {
+        if (view(to).copy_tail(from.genome(index), point))
+        {
+            invalidate(to);
+        }
+    }
+
+    /**
+     * @brief Mark a member's evaluation as stale, e.g. after crossover changed its genome.
+     */
+    void invalidate(size_t index) { this->evaluated[index] = false; }
+
+    /**
+     * @brief Check if a member's fitness and objective belong to its genome.
+     */
+    bool is_evaluated(size_t index) const { return this->evaluated[index]; }
+
+    /**
+     * @brief Store a member's objective function value and derive its fitness.
+     */
+    void set_result(size_t index, double objective)
+    {
+        auto fitness = this->schema.function->fitnessFunction(objective);
+        assert(fitness >= 0.0);
+        this->fitness_values[index] = fitness;
+        this->objective_values[index] = objective;
+        this->evaluated[index] = true;
+    }
+
+    double fitness(size_t index) const
+    {
+        assert(this->evaluated[index]);
+        return this->fitness_values[index];
+    }
+    double objective(size_t index) const
+    {
+        assert(this->evaluated[index]);
+        return this->objective_values[index];
+    }
+
+    /**
+     * @brief Get the fitness of every member, e.g. to prepare a selection.
+     * Only meaningful once every member is evaluated.
+     */
+    std::span<const double> fitness() const { return this->fitness_values; }
+
+    /**
+     * @brief Decode a member's genome into its variables.
+     */
+    std::vector<double> decode(size_t index) const
+    {
+        std::vector<double> x(this->schema.number_of_variables);
+        decode(index, x);
+        return x;
+    }
+
+    /**
+     * @brief Decode a member's genome into an existing buffer.
+     * @param index The member.
+     * @param out The buffer, number_of_variables long.
+     */
+    void decode(size_t index, std::span<double> out) const
+    {
+        assert(out.size() == this->schema.number_of_variables);
+        for (size_t group = 0; group < out.size(); group++)
+        {
+            out[group] = this->schema.decode(words_of(index), group);
+        }
+    }
+
+    /**
+     * @brief Keep per-variable terms with every member, for evaluate_terms().
+     * The terms of all members are allocated here, never on first use, so
+     * members can be evaluated and copied from several threads; resize()
+     * and copies keep them. Call it before any parallel region that uses them.
+     */
+    void enable_terms()
+    {
+        if (this->tracks_terms)
+        {
+            return;
+        }
+        this->tracks_terms = true;
+        this->terms.resize(this->count * this->schema.number_of_variables);
+        this->term_groups.resize(this->count * this->schema.number_of_variables);
+        this->has_terms.assign(this->count, false);
+    }
+
+    /**
+     * @brief Evaluate a separable objective from per-variable terms.
+     * The terms and the raw bits of the groups they were computed from are
+     * kept with the member (and copied with it), so after crossover or
+     * mutation only the groups whose bits changed are decoded and have
+     * their term recomputed.
+     * @return The number of recomputed terms.
+     */
+    size_t evaluate_terms(size_t index)
+    {
+        const auto &function = *this->schema.function;
+        assert(function.isSeparable() && this->tracks_terms);
+        auto groups = this->schema.number_of_variables;
+        auto fresh = !this->has_terms[index];
+        auto member = words_of(index);
+        size_t recomputed = 0;
+        double sum = 0.0;
+        for (size_t group = 0; group < groups; group++)
+        {
+            auto slot = index * groups + group;
+            auto bits = bitops::extract(member, group * this->schema.variable_size, this->schema.variable_size);
+            if (fresh || bits != this->term_groups[slot])
+            {
+                this->terms[slot] = function.term(group, this->schema.decode(member, group));
+                this->term_groups[slot] = bits;
+                recomputed++;
+            }
+            sum += this->terms[slot];
+        }
+        this->has_terms[index] = true;
+        set_result(index, function.combineTerms(sum));
+        return recomputed;
+    }
+
+private:
+    void copy_terms(size_t to, const Population &from, size_t index)
+    {
+        auto groups = this->schema.number_of_variables;
+        if (!from.tracks_terms || !from.has_terms[index])
+        {
+            this->has_terms[to] = false;
+            return;
+        }
+        std::copy_n(from.terms.begin() + (std::ptrdiff_t)(index * groups), groups, this->terms.begin() + (std::ptrdiff_t)(to * groups));
+        std::copy_n(from.term_groups.begin() + (std::ptrdiff_t)(index * groups), groups, this->term_groups.begin() + (std::ptrdiff_t)(to * groups));
+        this->has_terms[to] = true;
+    }
+};
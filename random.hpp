@@ -0,0 +1,367 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <random>
+#include <span>
+#include <string_view>
+
+/**
+ * Seedable, counter-based random number streams.
+ * A stream is identified by (seed, phase, run, generation, slot) and its
+ * numbers are a pure function of that identity (by default the Philox4x64-10
+ * blocks of successive counters under it), so any stream can be created anywhere, in any order, on any
+ * thread, and always produces the same numbers. The engines seat the calling
+ * thread's generator on the stream of each unit of work (one individual or
+ * pair of a generation), which makes a run depend on its seed only, not on
+ * the thread count or on which thread executes which unit.
+ * Philox itself is the default engine; xoshiro256++, PCG64 and mt19937_64
+ * can be built in instead, each seeded from the Philox block of the stream
+ * identity, so every engine keeps the same stream structure.
+ */
+namespace rng
+{
+    __extension__ typedef unsigned __int128 uint128;
+
+    /**
+     * What a stream is used for. Units of different phases of the same
+     * generation and slot get independent streams.
+     */
+    enum class Phase : uint64_t
+    {
+        // Drawing the initial population; unseated generators also use it.
+        initialization,
+        // Generation-level selection: SUS spins, CHC pairing shuffles.
+        selection,
+        // Crossover and mutation of one pair or individual.
+        breeding,
+        // Noise of noisy objectives, one slot per evaluated individual.
+        evaluation,
+        // CHC cataclysmic restarts.
+        restart,
+        // Drawing parameters for a run, e.g. in the parameter search.
+        parameters,
+        // Drawing the migration routes of an island model.
+        migration
+    };
+
+    /**
+     * The Philox4x64-10 block function (Salmon et al., "Parallel random
+     * numbers: as easy as 1, 2, 3", SC 2011).
+     */
+    constexpr std::array<uint64_t, 4> philox4x64(std::array<uint64_t, 4> counter, std::array<uint64_t, 2> key)
+    {
+        constexpr uint64_t multiplier0 = 0xD2E7470EE14C6C93, multiplier1 = 0xCA5A826395121157;
+        constexpr uint64_t weyl0 = 0x9E3779B97F4A7C15, weyl1 = 0xBB67AE8584CAA73B;
+        for (int round = 0; round < 10; round++)
+        {
+            auto product0 = (uint128)multiplier0 * counter[0];
+            auto product1 = (uint128)multiplier1 * counter[2];
+            counter = {(uint64_t)(product1 >> 64) ^ counter[1] ^ key[0],
+                       (uint64_t)product1,
+                       (uint64_t)(product0 >> 64) ^ counter[3] ^ key[1],
+                       (uint64_t)product0};
+            key[0] += weyl0;
+            key[1] += weyl1;
+        }
+        return counter;
+    }
+
+    /**
+     * Philox4x64-10 used directly as the engine: the stream identity is the
+     * counter and key, so seating a stream costs nothing and numbers are
+     * produced one block of four at a time.
+     */
+    class PhiloxEngine
+    {
+    private:
+        std::array<uint64_t, 4> counter;
+        std::array<uint64_t, 2> key;
+        std::array<uint64_t, 4> block{};
+        size_t used = 4;
+
+    public:
+        PhiloxEngine(std::array<uint64_t, 4> counter, std::array<uint64_t, 2> key) : counter(counter), key(key) {}
+
+        uint64_t operator()()
+        {
+            if (this->used == this->block.size())
+            {
+                this->block = philox4x64(this->counter, this->key);
+                this->counter[0]++;
+                this->used = 0;
+            }
+            return this->block[this->used++];
+        }
+    };
+
+    /**
+     * xoshiro256++ (Blackman and Vigna), seeded with the Philox block of the
+     * stream identity. The fastest engine per number once seated.
+     */
+    class Xoshiro256ppEngine
+    {
+    private:
+        std::array<uint64_t, 4> state;
+
+    public:
+        Xoshiro256ppEngine(std::array<uint64_t, 4> counter, std::array<uint64_t, 2> key) : state(philox4x64(counter, key))
+        {
+            if ((this->state[0] | this->state[1] | this->state[2] | this->state[3]) == 0)
+            {
+                this->state[0] = 1;
+            }
+        }
+
+        uint64_t operator()()
+        {
+            auto &s = this->state;
+            auto result = std::rotl(s[0] + s[3], 23) + s[0];
+            auto t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = std::rotl(s[3], 45);
+            return result;
+        }
+    };
+
+    /**
+     * PCG64 (XSL-RR 128/64, O'Neill), with state and increment from the
+     * Philox block of the stream identity.
+     */
+    class Pcg64Engine
+    {
+    private:
+        static constexpr uint128 multiplier = (uint128)2549297995355413924ULL << 64 | 4865540595714422341ULL;
+        uint128 state;
+        uint128 increment;
+
+    public:
+        Pcg64Engine(std::array<uint64_t, 4> counter, std::array<uint64_t, 2> key)
+        {
+            auto seed = philox4x64(counter, key);
+            this->increment = ((uint128)seed[2] << 64 | seed[3]) | 1;
+            this->state = ((uint128)seed[0] << 64 | seed[1]) + this->increment;
+            this->state = this->state * multiplier + this->increment;
+        }
+
+        uint64_t operator()()
+        {
+            this->state = this->state * multiplier + this->increment;
+            auto rotation = (int)(this->state >> 122);
+            return std::rotr((uint64_t)(this->state >> 64) ^ (uint64_t)this->state, rotation);
+        }
+    };
+
+    /**
+     * std::mt19937_64 seeded with the first word of the Philox block of the
+     * stream identity. Kept for comparison with the original generator;
+     * starting a stream initializes its whole 312-word state, so it is the
+     * slowest option.
+     */
+    class Mt19937Engine
+    {
+    private:
+        std::mt19937_64 engine;
+
+    public:
+        Mt19937Engine(std::array<uint64_t, 4> counter, std::array<uint64_t, 2> key) : engine(philox4x64(counter, key)[0]) {}
+
+        uint64_t operator()() { return this->engine(); }
+    };
+
+    /**
+     * One random stream, usable wherever a UniformRandomBitGenerator is expected.
+     * Copying a stream copies its position. The engine is only built on the
+     * first draw, so seating a stream that is never drawn from is free.
+     * Besides single draws it offers the bulk and bounded draws the genetic
+     * operators need, which skip the std distribution objects. A bulk draw
+     * consumes the stream exactly as the same single draws in a row, so
+     * callers can batch draws without changing results.
+     * @tparam Engine The engine producing the numbers, built from the stream identity.
+     */
+    template <typename Engine>
+    class BasicStream
+    {
+    public:
+        using result_type = uint64_t;
+
+    private:
+        // counter = {block, slot, generation, run}, key = {seed, phase}.
+        std::array<uint64_t, 4> counter{};
+        std::array<uint64_t, 2> key{};
+        std::optional<Engine> started;
+
+        Engine &engine()
+        {
+            if (!this->started)
+            {
+                this->started.emplace(this->counter, this->key);
+            }
+            return *this->started;
+        }
+
+    public:
+        BasicStream() = default;
+        BasicStream(uint64_t seed, Phase phase, uint64_t run, uint64_t generation, uint64_t slot) : counter{0, slot, generation, run},
+                                                                                                     key{seed, (uint64_t)phase} {}
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()() { return engine()(); }
+
+        /**
+         * @brief Get the stream offset slots after this one, from its start.
+         * Lets a callee that works on a range of slots (e.g. a batch of
+         * individuals) reach the stream of each of them.
+         */
+        BasicStream sibling(uint64_t offset) const
+        {
+            BasicStream other;
+            other.counter = {0, this->counter[1] + offset, this->counter[2], this->counter[3]};
+            other.key = this->key;
+            return other;
+        }
+
+        /**
+         * @brief Draw a double uniformly from [0, 1) with 53 random bits.
+         */
+        double uniform()
+        {
+            return (double)(engine()() >> 11) * 0x1p-53;
+        }
+
+        /**
+         * @brief Draw an integer uniformly from [0, bound).
+         * Lemire's multiply-and-shift; a division is only needed on the rare
+         * draws that land in the biased range.
+         */
+        uint64_t bounded(uint64_t bound)
+        {
+            assert(bound > 0);
+            auto &generator = engine();
+            auto product = (uint128)generator() * bound;
+            if ((uint64_t)product < bound)
+            {
+                auto threshold = (0 - bound) % bound;
+                while ((uint64_t)product < threshold)
+                {
+                    product = (uint128)generator() * bound;
+                }
+            }
+            return (uint64_t)(product >> 64);
+        }
+
+        /**
+         * @brief Fill a buffer with raw 64-bit words, e.g. a whole random genome.
+         */
+        void fill(std::span<uint64_t> words)
+        {
+            auto &generator = engine();
+            for (auto &word : words)
+            {
+                word = generator();
+            }
+        }
+
+        /**
+         * @brief Fill a buffer with doubles drawn uniformly from [0, 1).
+         * Consumes the stream exactly as successive uniform() calls would.
+         * The words are drawn first and converted in a separate pass the
+         * compiler can vectorize.
+         */
+        void fill_uniform(std::span<double> out)
+        {
+            auto &generator = engine();
+            for (auto &value : out)
+            {
+                value = std::bit_cast<double>(generator());
+            }
+            for (auto &value : out)
+            {
+                value = (double)(std::bit_cast<uint64_t>(value) >> 11) * 0x1p-53;
+            }
+        }
+
+        /**
+         * @brief Fill a buffer with integers drawn uniformly from [0, bound).
+         * Consumes the stream exactly as successive bounded() calls would,
+         * but computes the rejection threshold at most once per fill.
+         */
+        void fill_bounded(std::span<uint64_t> out, uint64_t bound)
+        {
+            assert(bound > 0);
+            auto &generator = engine();
+            std::optional<uint64_t> threshold;
+            for (auto &value : out)
+            {
+                auto product = (uint128)generator() * bound;
+                if ((uint64_t)product < bound)
+                {
+                    if (!threshold)
+                    {
+                        threshold = (0 - bound) % bound;
+                    }
+                    while ((uint64_t)product < *threshold)
+                    {
+                        product = (uint128)generator() * bound;
+                    }
+                }
+                value = (uint64_t)(product >> 64);
+            }
+        }
+    };
+
+#if defined(GA_RNG_XOSHIRO256PP)
+    using Engine = Xoshiro256ppEngine;
+#elif defined(GA_RNG_PCG64)
+    using Engine = Pcg64Engine;
+#elif defined(GA_RNG_MT19937)
+    using Engine = Mt19937Engine;
+#else
+    using Engine = PhiloxEngine;
+#endif
+
+    // The stream type behind get_generator(). Engines are pluggable at compile time
+    // only: GA_RNG_ENGINE picks one when configuring, there is no runtime switch.
+    using Stream = BasicStream<Engine>;
+
+    /**
+     * @brief Derive the seed of a named part of a program run, e.g. one output file.
+     * The name is hashed (FNV-1a) and mixed with the seed through the Philox
+     * block function, so parts with different names draw from unrelated
+     * streams under one seed, and a part's streams depend only on its name.
+     */
+    constexpr uint64_t derive_seed(uint64_t seed, std::string_view name)
+    {
+        uint64_t hash = 0xCBF29CE484222325;
+        for (auto c : name)
+        {
+            hash = (hash ^ (uint8_t)c) * 0x100000001B3;
+        }
+        return philox4x64({hash, 0, 0, 0}, {seed, 0})[0];
+    }
+
+    /**
+     * @brief Draw a seed from the system's entropy source, for runs that are not given one.
+     */
+    inline uint64_t random_seed()
+    {
+        static thread_local std::random_device device;
+        return (uint64_t)device() << 32 | device();
+    }
+}
+
+/**
+ * @brief Get the calling thread's generator.
+ * Engines assign it the stream of each unit of work before drawing from it;
+ * until then it is a stream with a random seed.
+ */
+extern rng::Stream &get_generator();
@@ -0,0 +1,331 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+/**
+ * One row of a result file: up to max_fields numbers, integers first,
+ * written comma-separated. A record that closes its file has no fields.
+ */
+struct ResultRecord
+{
+    static constexpr size_t max_fields = 8;
+
+    uint32_t file = 0;
+    uint32_t integer_fields = 0;
+    uint32_t real_fields = 0;
+    bool closes_file = false;
+    std::array<uint64_t, max_fields> integers;
+    std::array<double, max_fields> reals;
+};
+
+/**
+ * Writes CSV result files on a thread of its own.
+ * Workers push() fixed-size records into a bounded lock-free queue (one
+ * slot per record, each with a sequence number, so producers only contend
+ * on claiming a position) and go on; they only wait if the writer falls
+ * a whole queue behind. The writer thread formats the records with
+ * std::to_chars into a large buffer per file and writes a buffer out when
+ * it is full or its file is closed, so the disk sees few large writes.
+ * Reals are formatted like std::ostream's default (%g, 6 significant
+ * digits), so the files are byte for byte those a stream would write.
+ * Rows of a file appear in the order they were pushed. Producers only
+ * notify the writer when it has gone to sleep on an empty queue. A file
+ * that cannot be written or closed is reported by name once, and its
+ * further rows are dropped.
+ */
+class ResultWriter
+{
+private:
+    static constexpr size_t buffer_size = 1 << 20;
+    // Room for a formatted record of max_fields numbers.
+    static constexpr size_t record_room = 64 * 2 * ResultRecord::max_fields;
+
+    struct File
+    {
+        std::string filename;
+        std::string header;
+        std::ofstream stream;
+        std::vector<char> buffer;
+        size_t used = 0;
+        bool opened = false;
+        bool failed = false;
+    };
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        ResultRecord record;
+    };
+
+    size_t capacity;
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<uint64_t> tail = 0;
+    alignas(64) std::atomic<uint64_t> published = 0;
+    alignas(64) uint64_t head = 0;
+    // Set while the writer waits for records, so only then do producers notify it.
+    alignas(64) std::atomic<bool> sleeping = false;
+    std::atomic<bool> stopping = false;
+
+    std::mutex files_mutex;
+    std::vector<std::unique_ptr<File>> files;
+    // The writer's copy of files, so it only locks for files it has not seen.
+    std::vector<File *> writer_files;
+    std::jthread writer;
+
+    bool pop(ResultRecord &record)
+    {
+        auto &slot = this->slots[this->head % this->capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != this->head + 1)
+        {
+            return false;
+        }
+        record = slot.record;
+        slot.sequence.store(this->head + this->capacity, std::memory_order_release);
+        this->head++;
+        return true;
+    }
+
+    File &writer_file(uint32_t id)
+    {
+        if (id >= this->writer_files.size())
+        {
+            std::lock_guard lock(this->files_mutex);
+            for (auto i = this->writer_files.size(); i < this->files.size(); i++)
+            {
+                this->writer_files.push_back(this->files[i].get());
+            }
+        }
+        auto &file = *this->writer_files[id];
+        if (!file.opened)
+        {
+            file.opened = true;
+            file.stream.open(file.filename, std::ios::out | std::ios::trunc | std::ios::binary);
+            file.failed = !file.stream.is_open();
+            if (file.failed)
+            {
+                std::cout << "Could not open file " << file.filename << std::endl;
+            }
+            else
+            {
+                file.buffer.resize(buffer_size);
+                std::ranges::copy(file.header, file.buffer.begin());
+                file.used = file.header.size();
+                file.buffer[file.used++] = '\n';
+            }
+        }
+        return file;
+    }
+
+    // Report the first failure of a file's stream; the file takes no more rows after it.
+    static void check(File &file, const char *action)
+    {
+        if (file.stream.fail() && !file.failed)
+        {
+            file.failed = true;
+            std::cout << "Could not " << action << " file " << file.filename << std::endl;
+        }
+    }
+
+    static void flush(File &file)
+    {
+        file.stream.write(file.buffer.data(), (std::streamsize)file.used);
+        file.used = 0;
+        check(file, "write");
+    }
+
+    static void close_file(File &file)
+    {
+        flush(file);
+        file.stream.close();
+        check(file, "close");
+        file.buffer = {};
+    }
+
+    void write(const ResultRecord &record)
+    {
+        auto &file = writer_file(record.file);
+        if (record.closes_file)
+        {
+            if (file.stream.is_open())
+            {
+                close_file(file);
+            }
+            return;
+        }
+        if (file.failed)
+        {
+            return;
+        }
+        assert(file.stream.is_open());
+        if (file.buffer.size() - file.used < record_room)
+        {
+            flush(file);
+        }
+        auto *first = file.buffer.data() + file.used, *last = file.buffer.data() + file.buffer.size();
+        for (size_t i = 0; i < record.integer_fields; i++)
+        {
+            first = std::to_chars(first, last, record.integers[i]).ptr;
+            *first++ = ',';
+        }
+        for (size_t i = 0; i < record.real_fields; i++)
+        {
+            first = std::to_chars(first, last, record.reals[i], std::chars_format::general, 6).ptr;
+            *first++ = ',';
+        }
+        // The last separator ends the row.
+        *(first - 1) = '\n';
+        file.used = (size_t)(first - file.buffer.data());
+    }
+
+    void work()
+    {
+        ResultRecord record;
+        while (true)
+        {
+            auto seen = this->published.load(std::memory_order_acquire);
+            auto stop = this->stopping.load(std::memory_order_acquire);
+            while (pop(record))
+            {
+                write(record);
+            }
+            if (stop)
+            {
+                break;
+            }
+            // Announce the sleep before waiting: a producer that publishes after
+            // this store sees it and notifies, one that published before makes
+            // the wait return at once.
+            this->sleeping.store(true, std::memory_order_seq_cst);
+            this->published.wait(seen, std::memory_order_seq_cst);
+            this->sleeping.store(false, std::memory_order_relaxed);
+        }
+        // Files that were never closed still get their rows.
+        for (auto *file : this->writer_files)
+        {
+            if (file->stream.is_open())
+            {
+                close_file(*file);
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Start the writer thread.
+     * @param queue_capacity The number of records that may wait for the writer.
+     */
+    explicit ResultWriter(size_t queue_capacity = 1 << 14) : capacity(queue_capacity),
+                                                             slots(std::make_unique<Slot[]>(queue_capacity))
+    {
+        assert(queue_capacity > 0);
+        for (size_t i = 0; i < this->capacity; i++)
+        {
+            this->slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        this->writer = std::jthread([this]
+                                    { work(); });
+    }
+
+    /**
+     * @brief Write every pushed record and stop the writer.
+     */
+    ~ResultWriter()
+    {
+        finish();
+    }
+
+    ResultWriter(const ResultWriter &) = delete;
+    ResultWriter &operator=(const ResultWriter &) = delete;
+
+    /**
+     * @brief Add a file; it is created by the writer when its first record arrives.
+     * @param filename The file, truncated if it exists.
+     * @param header The first line, without its line break.
+     * @return The file's id for ResultRecord::file.
+     */
+    uint32_t open(std::string filename, std::string header)
+    {
+        std::lock_guard lock(this->files_mutex);
+        auto file = std::make_unique<File>();
+        file->filename = std::move(filename);
+        file->header = std::move(header);
+        this->files.push_back(std::move(file));
+        return (uint32_t)(this->files.size() - 1);
+    }
+
+    /**
+     * @brief Queue a record; thread-safe, waits only while the queue is full.
+     */
+    void push(const ResultRecord &record)
+    {
+        assert(record.integer_fields + record.real_fields <= ResultRecord::max_fields);
+        auto position = this->tail.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true)
+        {
+            slot = &this->slots[position % this->capacity];
+            auto sequence = slot->sequence.load(std::memory_order_acquire);
+            if (sequence == position)
+            {
+                if (this->tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else
+            {
+                // The slot still holds a record from a lap ago: the queue is full.
+                if (sequence < position)
+                {
+                    std::this_thread::yield();
+                }
+                position = this->tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->record = record;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        this->published.fetch_add(1, std::memory_order_seq_cst);
+        if (this->sleeping.load(std::memory_order_seq_cst))
+        {
+            this->published.notify_one();
+        }
+    }
+
+    /**
+     * @brief Queue the end of a file: its rows are written out and it is closed.
+     */
+    void close(uint32_t file)
+    {
+        ResultRecord record;
+        record.file = file;
+        record.closes_file = true;
+        push(record);
+    }
+
+    /**
+     * @brief Wait until every pushed record is written and stop the writer.
+     * No records may be pushed during or after the call.
+     */
+    void finish()
+    {
+        if (!this->writer.joinable())
+        {
+            return;
+        }
+        this->stopping.store(true, std::memory_order_release);
+        this->published.fetch_add(1, std::memory_order_release);
+        this->published.notify_one();
+        this->writer.join();
+    }
+};
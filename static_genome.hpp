@@ -0,0 +1,134 @@
+#pragma once
+#include <array>
+#include <span>
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <random>
+
+#include "bitstring.hpp"
+
+#include "random.hpp"
+
+/**
+ * A packed genome whose geometry is known at compile time.
+ * Uses the same word layout as bitstring, but the words live in a fixed-size
+ * std::array, so a genome is a plain value with no heap storage and every
+ * loop over its bits or groups has a constant trip count.
+ * @tparam VariableSize The number of bits per variable.
+ * @tparam NumberOfVariables The number of variables.
+ */
+template <size_t VariableSize, size_t NumberOfVariables>
+class StaticGenome
+{
+public:
+    static constexpr size_t variable_size = VariableSize;
+    static constexpr size_t number_of_variables = NumberOfVariables;
+    static constexpr size_t bits = VariableSize * NumberOfVariables;
+    static constexpr size_t word_count = bitops::words_for(bits);
+
+    static_assert(VariableSize > 0 && VariableSize <= 64);
+    static_assert(NumberOfVariables > 0);
+
+private:
+    // bitops::hash of the words, kept up to date by every modification.
+    // Declared first so equality compares it before the words.
+    uint64_t hash_value = bitops::hash(std::array<uint64_t, word_count>{});
+    std::array<uint64_t, word_count> words{};
+
+public:
+    bool operator==(const StaticGenome &other) const = default;
+
+    static constexpr size_t size() { return bits; }
+
+    /**
+     * @brief Get the bit at the given index.
+     */
+    uint8_t operator[](size_t index) const
+    {
+        assert(index < bits);
+        return (this->words[index / bitops::word_bits] & bitops::mask_of(index)) != 0;
+    }
+
+    /**
+     * @brief Set the bit at the given index.
+     */
+    void set(size_t index, uint8_t value)
+    {
+        assert(index < bits);
+        if ((*this)[index] != value)
+        {
+            flip(index);
+        }
+    }
+
+    /**
+     * @brief Flip the bit at the given index.
+     */
+    void flip(size_t index)
+    {
+        assert(index < bits);
+        xor_word(index / bitops::word_bits, bitops::mask_of(index));
+    }
+
+    /**
+     * @brief Flip the bits of one word selected by a mask, updating the hash incrementally.
+     */
+    void xor_word(size_t word, uint64_t mask)
+    {
+        assert(word + 1 < word_count || (mask & ~bitops::tail_mask(bits)) == 0);
+        auto old = this->words[word];
+        this->words[word] ^= mask;
+        this->hash_value ^= bitops::mix(old, word) ^ bitops::mix(this->words[word], word);
+    }
+
+    /**
+     * @brief One-point crossover: exchange every bit from point onwards with another genome.
+     */
+    void swap_tail(StaticGenome &other, size_t point)
+    {
+        bitops::swap_tail(this->words, other.words, point);
+        this->hash_value = bitops::hash(this->words);
+        other.hash_value = bitops::hash(other.words);
+    }
+
+    std::span<const uint64_t, word_count> get_words() const { return this->words; }
+
+    size_t hamming_distance(const StaticGenome &other) const
+    {
+        return bitops::hamming_distance(this->words, other.words);
+    }
+
+    uint64_t hash() const
+    {
+        return this->hash_value;
+    }
+
+    /**
+     * @brief Fill the genome with random bits.
+     */
+    void randomize()
+    {
+        get_generator().fill(this->words);
+        this->words.back() &= bitops::tail_mask(bits);
+        this->hash_value = bitops::hash(this->words);
+    }
+
+    /**
+     * @brief Decode every variable of the genome.
+     * @param min The value of a group of all zeros.
+     * @param max The value of a group of all ones.
+     * @return The decoded variables.
+     */
+    std::array<double, NumberOfVariables> decode(double min, double max) const
+    {
+        constexpr double full = (double)(~uint64_t{0} >> (64 - VariableSize));
+        std::array<double, NumberOfVariables> result;
+        for (size_t group = 0; group < NumberOfVariables; group++)
+        {
+            auto val = bitops::extract(this->words, group * VariableSize, VariableSize);
+            result[group] = min + (max - min) * ((double)val / full);
+        }
+        return result;
+    }
+};
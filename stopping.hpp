@@ -0,0 +1,117 @@
+#pragma once
+#include <chrono>
+#include <optional>
+#include <limits>
+#include <cstdint>
+
+/**
+ * When a run may end before its last generation. Every criterion is off
+ * by default; a run stops after recording the first generation that meets
+ * any of them, and its series then ends with that generation.
+ */
+struct StoppingCriteria
+{
+    // Stop once the best objective value is within this of the function's
+    // getMinY(). Ignored for noisy objectives, whose best value can
+    // undershoot the minimum by chance.
+    std::optional<double> target_epsilon;
+    // Stop after this many generations in a row without a lower best objective value; 0 for never.
+    size_t stagnation_generations = 0;
+    // Stop once the run has made this many objective evaluations; 0 for no limit.
+    uint64_t max_evaluations = 0;
+    // Stop once the run has taken this long; zero for no limit.
+    std::chrono::steady_clock::duration time_limit{};
+    // Stop once every member is the same genome.
+    bool stop_when_converged = false;
+
+    bool any() const
+    {
+        return target_epsilon || stagnation_generations > 0 || max_evaluations > 0 || time_limit.count() > 0 || stop_when_converged;
+    }
+};
+
+/**
+ * Applies StoppingCriteria to the generations of one run as they are recorded.
+ */
+class StoppingRule
+{
+private:
+    StoppingCriteria criteria;
+    double best = std::numeric_limits<double>::infinity();
+    size_t stagnant = 0;
+    std::chrono::steady_clock::time_point started;
+
+public:
+    StoppingRule() = default;
+    explicit StoppingRule(const StoppingCriteria &criteria) : criteria(criteria) {}
+
+    const StoppingCriteria &get_criteria() const { return this->criteria; }
+
+    /**
+     * @brief Start a run: no best value yet, and the clock starts now.
+     */
+    void start()
+    {
+        this->best = std::numeric_limits<double>::infinity();
+        this->stagnant = 0;
+        if (this->criteria.time_limit.count() > 0)
+        {
+            this->started = std::chrono::steady_clock::now();
+        }
+    }
+
+    /**
+     * @brief Get the time since start(), or zero if there is no time limit.
+     */
+    std::chrono::steady_clock::duration elapsed() const
+    {
+        if (this->criteria.time_limit.count() == 0)
+        {
+            return {};
+        }
+        return std::chrono::steady_clock::now() - this->started;
+    }
+
+    /**
+     * @brief Check whether the run ends after a generation.
+     * @param best_objective The generation's best objective function value.
+     * @param distinct_individuals The number of distinct genomes in the generation.
+     * @param evaluations The number of objective evaluations of the run so far.
+     * @param elapsed The time the run had taken when the generation was recorded, see elapsed().
+     * @param min_y The objective's getMinY().
+     * @param deterministic Whether the objective is deterministic.
+     */
+    bool should_stop(double best_objective, size_t distinct_individuals, uint64_t evaluations, std::chrono::steady_clock::duration elapsed, double min_y, bool deterministic)
+    {
+        if (!this->criteria.any())
+        {
+            return false;
+        }
+        if (best_objective < this->best)
+        {
+            this->best = best_objective;
+            this->stagnant = 0;
+        }
+        else
+        {
+            this->stagnant++;
+        }
+        if (this->criteria.target_epsilon && deterministic && best_objective <= min_y + *this->criteria.target_epsilon)
+        {
+            return true;
+        }
+        if (this->criteria.stagnation_generations > 0 && this->stagnant >= this->criteria.stagnation_generations)
+        {
+            return true;
+        }
+        if (this->criteria.max_evaluations > 0 && evaluations >= this->criteria.max_evaluations)
+        {
+            return true;
+        }
+        if (this->criteria.stop_when_converged && distinct_individuals == 1)
+        {
+            return true;
+        }
+        return this->criteria.time_limit.count() > 0 && elapsed >= this->criteria.time_limit;
+    }
+};
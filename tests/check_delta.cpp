@@ -0,0 +1,99 @@
+#include "util.hpp"
+#include "Functions/dejong.hpp"
+#include "population.hpp"
+#include "mutation.hpp"
+#include <cmath>
+#include <iostream>
+
+// Checks delta evaluation against full evaluation: members of populations
+// that keep their per-variable terms are mutated, crossed over and copied
+// between populations, and after every change the value from the updated
+// terms must match eval() on the decoded genome to within rounding.
+
+namespace
+{
+    constexpr uint64_t seed = 0x5EED;
+
+    bool close(double delta, double full)
+    {
+        return std::abs(delta - full) <= 1e-12 * std::max(1.0, std::abs(full));
+    }
+
+    /**
+     * @brief Evaluate every stale member from its terms and compare with eval().
+     * Both evaluations draw noise from the same stream.
+     * @return The number of mismatches.
+     */
+    size_t check(Population &population, const OptimizationFunction &function, uint64_t round, size_t &recomputed, size_t &terms)
+    {
+        size_t mismatches = 0;
+        for (size_t i = 0; i < population.size(); i++)
+        {
+            if (function.isDeterministic() && population.is_evaluated(i))
+            {
+                continue;
+            }
+            auto stream = rng::Stream(seed, rng::Phase::evaluation, round, 0, i);
+            get_generator() = stream;
+            recomputed += population.evaluate_terms(i);
+            terms += function.getNumberOfVariables();
+            auto delta = population.objective(i);
+            get_generator() = stream;
+            auto x = population.decode(i);
+            auto full = function.eval(x);
+            if (!close(delta, full))
+            {
+                std::cout << "round " << round << " member " << i << ": " << delta << " from terms, " << full << " from eval" << std::endl;
+                mismatches++;
+            }
+        }
+        return mismatches;
+    }
+}
+
+int main()
+{
+    dejong::DeJong1 dejong1;
+    dejong::DeJong3 dejong3;
+    dejong::DeJong4 dejong4;
+    const std::pair<const char *, OptimizationFunction *> functions[] = {{"dejong1", &dejong1}, {"dejong3", &dejong3}, {"dejong4", &dejong4}};
+    constexpr size_t population_size = 40, rounds = 100;
+    size_t mismatches = 0;
+    for (auto [name, function] : functions)
+    {
+        for (size_t variable_size : {7uz, 32uz})
+        {
+            GenomeSchema schema(variable_size, function->getNumberOfVariables(), *function);
+            Population current(schema, population_size), other(schema, population_size);
+            current.enable_terms();
+            other.enable_terms();
+            for (size_t i = 0; i < population_size; i++)
+            {
+                get_generator() = rng::Stream(seed, rng::Phase::initialization, 0, 0, i);
+                current.randomize(i);
+            }
+            GeometricMutation mutation(1.0 / (double)schema.bits);
+            size_t recomputed = 0, terms = 0;
+            for (uint64_t round = 0; round < rounds; round++)
+            {
+                mismatches += check(current, *function, round, recomputed, terms);
+                // Breed the other population from this one, as the engines do.
+                for (size_t i = 0; i < population_size; i++)
+                {
+                    auto &generator = get_generator();
+                    generator = rng::Stream(seed, rng::Phase::breeding, round, 0, i);
+                    other.copy(i, current, generator.bounded(population_size));
+                    if (i % 2 == 1 && generator.uniform() < 0.6)
+                    {
+                        other.swap_tail(i - 1, i, generator.bounded(schema.bits));
+                    }
+                    other.mutate(i, mutation);
+                }
+                std::swap(current, other);
+            }
+            std::cout << name << " with " << variable_size << "-bit variables: " << recomputed << " of " << terms << " terms recomputed" << std::endl;
+        }
+    }
+    std::cout << "Checked delta evaluation: " << (mismatches == 0 ? "all match" : "MISMATCH") << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
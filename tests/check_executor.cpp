@@ -0,0 +1,98 @@
+#include "util.hpp"
+#include "Functions/dejong.hpp"
+#include "Functions/slow_function.hpp"
+#include "Algorithms/engine_factory.hpp"
+#include "evaluation_executor.hpp"
+#include <bit>
+#include <iostream>
+#include <thread>
+
+// Checks that runs evaluating on an EvaluationExecutor reproduce the
+// synchronous runs bit for bit: SimpleGA and CHC on a SlowFunction, with
+// one or several workers and with two runs sharing the executor, against
+// the same configuration run without one. A wrapped function never gets a
+// specialized engine, so these are the engines that use the executor.
+
+namespace
+{
+    bool same(double a, double b)
+    {
+        return std::bit_cast<uint64_t>(a) == std::bit_cast<uint64_t>(b);
+    }
+
+    bool same(const std::vector<GenerationPerformance> &a, const std::vector<GenerationPerformance> &b)
+    {
+        auto equal = a.size() == b.size();
+        for (size_t g = 0; equal && g < a.size(); g++)
+        {
+            equal = a[g].generation == b[g].generation && a[g].distinct_individuals == b[g].distinct_individuals &&
+                    same(a[g].best_fitness, b[g].best_fitness) && same(a[g].average_fitness, b[g].average_fitness) && same(a[g].worst_fitness, b[g].worst_fitness) &&
+                    same(a[g].best_objective_function_value, b[g].best_objective_function_value) &&
+                    same(a[g].average_objective_function_value, b[g].average_objective_function_value) &&
+                    same(a[g].worst_objective_function_value, b[g].worst_objective_function_value);
+        }
+        return equal;
+    }
+
+    std::unique_ptr<Algorithm> make(bool chc, OptimizationFunction &function, size_t population_size)
+    {
+        constexpr size_t generations = 25;
+        auto variables = function.getNumberOfVariables();
+        return chc ? make_chc(population_size, generations, 0.95, 0.05, 32, variables, function)
+                   : make_simple_ga(population_size, generations, 0.6, 0.01, 32, variables, function, SelectionStrategy::tournament, 3);
+    }
+}
+
+int main()
+{
+    constexpr uint64_t seed = 0xE8EC;
+    const char *names[] = {"dejong1", "dejong4"};
+    dejong::DeJong1 dejong1;
+    dejong::DeJong4 dejong4;
+    OptimizationFunction *functions[] = {&dejong1, &dejong4};
+    size_t mismatches = 0;
+    for (size_t f = 0; f < std::size(functions); f++)
+    {
+        SlowFunction slow(*functions[f], std::chrono::microseconds(1), false);
+        for (auto chc : {false, true})
+        {
+            for (size_t population_size : {31uz, 70uz})
+            {
+                std::vector<GenerationPerformance> expected[2];
+                for (size_t run = 0; run < 2; run++)
+                {
+                    auto synchronous = make(chc, slow, population_size);
+                    synchronous->set_seed(seed, run);
+                    expected[run] = synchronous->run();
+                }
+                for (size_t workers : {1uz, 3uz})
+                {
+                    auto executor = std::make_shared<EvaluationExecutor>(workers);
+                    std::vector<GenerationPerformance> series[2];
+                    {
+                        std::vector<std::jthread> runs;
+                        for (size_t run = 0; run < 2; run++)
+                        {
+                            runs.emplace_back([&, run]
+                                              {
+                                auto algorithm = make(chc, slow, population_size);
+                                algorithm->set_executor(executor);
+                                algorithm->set_seed(seed, run);
+                                series[run] = algorithm->run(); });
+                        }
+                    }
+                    for (size_t run = 0; run < 2; run++)
+                    {
+                        if (!same(series[run], expected[run]))
+                        {
+                            std::cout << names[f] << ", " << (chc ? "chc" : "simple_ga") << ", population " << population_size << ", " << workers << " workers, run " << run << " differs" << std::endl;
+                            mismatches++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "Checked executor runs: " << (mismatches == 0 ? "all match" : "MISMATCH") << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
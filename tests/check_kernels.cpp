@@ -0,0 +1,131 @@
+#include "util.hpp"
+#include "Functions/dejong.hpp"
+#include <bit>
+#include <iostream>
+
+// Checks every batch kernel the CPU supports against the scalar eval():
+// every column must match eval() to within rounding, and a column must get
+// the same bits from every kernel and at every position in the matrix, so
+// results do not depend on how members are grouped into blocks.
+
+namespace
+{
+    const char *isa_names[] = {"portable", "avx2", "avx512"};
+
+    /**
+     * @brief Fill a matrix with values drawn from the function's domain, its bounds and whole numbers included.
+     */
+    void draw(const OptimizationFunction &function, DecodedPopulation &X, rng::Stream &stream)
+    {
+        auto [min, max] = function.getXRange();
+        for (size_t v = 0; v < X.get_variables(); v++)
+        {
+            for (size_t i = 0; i < X.get_columns(); i++)
+            {
+                auto u = stream.uniform();
+                switch (stream.bounded(8))
+                {
+                case 0:
+                    X(v, i) = min;
+                    break;
+                case 1:
+                    X(v, i) = max;
+                    break;
+                case 2:
+                    X(v, i) = std::round(min + (max - min) * u);
+                    break;
+                default:
+                    X(v, i) = min + (max - min) * u;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Evaluate a matrix shifted right by some columns, so column i is evaluated at position shift + i.
+     * The generator is seated so every column keeps the stream of its unshifted position.
+     */
+    std::vector<double> evaluate_shifted(const OptimizationFunction &function, const DecodedPopulation &X, size_t shift, const rng::Stream &base)
+    {
+        DecodedPopulation shifted(X.get_variables(), X.get_columns() + shift);
+        for (size_t v = 0; v < X.get_variables(); v++)
+        {
+            for (size_t i = 0; i < X.get_columns(); i++)
+            {
+                shifted(v, shift + i) = X(v, i);
+            }
+            for (size_t i = 0; i < shift; i++)
+            {
+                shifted(v, i) = X(v, 0);
+            }
+        }
+        std::vector<double> out(shifted.get_columns());
+        get_generator() = base.sibling(1000 - shift);
+        function.evalBatch(shifted, out);
+        return std::vector<double>(out.begin() + (std::ptrdiff_t)shift, out.end());
+    }
+
+    bool check(const char *name, const OptimizationFunction &function, size_t columns, std::vector<double> &reference, dejong::KernelIsa isa)
+    {
+        DecodedPopulation X(function.getNumberOfVariables(), columns);
+        rng::Stream stream(7, rng::Phase::parameters, columns, 0, 0);
+        draw(function, X, stream);
+        rng::Stream base(11, rng::Phase::evaluation, 0, 0, 0);
+        std::vector<double> x(X.get_variables());
+        auto ok = true;
+        for (size_t shift = 0; shift < 9; shift++)
+        {
+            auto out = evaluate_shifted(function, X, shift, base);
+            for (size_t i = 0; i < columns; i++)
+            {
+                X.gather(i, x);
+                get_generator() = base.sibling(1000 + i);
+                auto expected = function.eval(x);
+                if (std::abs(out[i] - expected) > 1e-12 * std::max(1.0, std::abs(expected)))
+                {
+                    std::cout << name << " " << isa_names[(int)isa] << ": column " << i << " of " << columns << " is " << out[i] << ", eval() gives " << expected << std::endl;
+                    ok = false;
+                }
+            }
+            if (shift == 0 && isa == dejong::KernelIsa::portable)
+            {
+                reference = out;
+            }
+            for (size_t i = 0; i < columns; i++)
+            {
+                if (std::bit_cast<uint64_t>(out[i]) != std::bit_cast<uint64_t>(reference[i]))
+                {
+                    std::cout << name << " " << isa_names[(int)isa] << ": column " << i << " of " << columns << " at position " << shift + i << " differs from the portable kernel" << std::endl;
+                    ok = false;
+                }
+            }
+        }
+        return ok;
+    }
+}
+
+int main()
+{
+    dejong::DeJong1 dejong1;
+    dejong::DeJong2 dejong2;
+    dejong::DeJong3 dejong3;
+    dejong::DeJong4 dejong4;
+    dejong::DeJong5 dejong5;
+    std::pair<const char *, const OptimizationFunction *> functions[] = {{"dejong1", &dejong1}, {"dejong2", &dejong2}, {"dejong3", &dejong3}, {"dejong4", &dejong4}, {"dejong5", &dejong5}};
+    auto ok = true;
+    for (auto [name, function] : functions)
+    {
+        for (size_t columns : {1uz, 3uz, 4uz, 7uz, 8uz, 9uz, 15uz, 16uz, 17uz, 63uz, 64uz, 65uz, 200uz})
+        {
+            std::vector<double> reference;
+            for (auto isa = dejong::KernelIsa::portable; isa <= dejong::supported_kernels(); isa = (dejong::KernelIsa)((int)isa + 1))
+            {
+                dejong::use_kernels(isa);
+                ok = check(name, *function, columns, reference, isa) && ok;
+            }
+        }
+    }
+    dejong::use_kernels(dejong::supported_kernels());
+    std::cout << "Checked kernels up to " << isa_names[(int)dejong::supported_kernels()] << ": " << (ok ? "all match" : "MISMATCH") << std::endl;
+    return ok ? 0 : 1;
+}
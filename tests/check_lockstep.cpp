@@ -0,0 +1,80 @@
+#include "util.hpp"
+#include "Functions/dejong.hpp"
+#include "Algorithms/engine_factory.hpp"
+#include <bit>
+#include <iostream>
+
+// Checks that every lane of the lockstep SimpleGA reproduces the series of
+// the per-run engine bit for bit, for every production configuration, odd
+// and even populations, every selection scheme and several lane counts.
+
+namespace
+{
+    bool same(double a, double b)
+    {
+        return std::bit_cast<uint64_t>(a) == std::bit_cast<uint64_t>(b);
+    }
+
+    bool same(const GenerationPerformance &a, const GenerationPerformance &b)
+    {
+        auto solutions_match = a.best_solution.size() == b.best_solution.size() && a.worst_solution.size() == b.worst_solution.size();
+        for (size_t v = 0; solutions_match && v < a.best_solution.size(); v++)
+        {
+            solutions_match = same(a.best_solution[v], b.best_solution[v]) && same(a.worst_solution[v], b.worst_solution[v]);
+        }
+        return solutions_match && a.generation == b.generation && a.distinct_individuals == b.distinct_individuals &&
+               same(a.best_fitness, b.best_fitness) && same(a.average_fitness, b.average_fitness) && same(a.worst_fitness, b.worst_fitness) &&
+               same(a.best_objective_function_value, b.best_objective_function_value) &&
+               same(a.average_objective_function_value, b.average_objective_function_value) &&
+               same(a.worst_objective_function_value, b.worst_objective_function_value);
+    }
+}
+
+int main()
+{
+    constexpr uint64_t seed = 0x10C5;
+    constexpr size_t generations = 30, first_run = 5;
+    const char *names[] = {"dejong1", "dejong2", "dejong3", "dejong4", "dejong5"};
+    dejong::DeJong1 dejong1;
+    dejong::DeJong2 dejong2;
+    dejong::DeJong3 dejong3;
+    dejong::DeJong4 dejong4;
+    dejong::DeJong5 dejong5;
+    OptimizationFunction *functions[] = {&dejong1, &dejong2, &dejong3, &dejong4, &dejong5};
+    size_t mismatches = 0;
+    for (size_t f = 0; f < std::size(functions); f++)
+    {
+        auto &function = *functions[f];
+        auto variables = function.getNumberOfVariables();
+        for (auto strategy : {SelectionStrategy::proportional, SelectionStrategy::stochastic_universal, SelectionStrategy::tournament})
+        {
+            for (size_t population_size : {31uz, 70uz})
+            {
+                for (size_t runs : {1uz, 3uz, 8uz})
+                {
+                    auto lockstep = make_lockstep_simple_ga(population_size, generations, 0.6, 0.01, 32, variables, function, runs, strategy, 3);
+                    lockstep->set_seed(seed, first_run);
+                    auto series = lockstep->run();
+                    for (size_t lane = 0; lane < runs; lane++)
+                    {
+                        auto single = make_simple_ga(population_size, generations, 0.6, 0.01, 32, variables, function, strategy, 3);
+                        single->set_seed(seed, first_run + lane);
+                        auto expected = single->run();
+                        auto equal = series[lane].size() == expected.size();
+                        for (size_t g = 0; equal && g < expected.size(); g++)
+                        {
+                            equal = same(series[lane][g], expected[g]);
+                        }
+                        if (!equal)
+                        {
+                            std::cout << names[f] << ", population " << population_size << ", selection " << (int)strategy << ", lane " << lane << " of " << runs << " differs" << std::endl;
+                            mismatches++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "Checked lockstep runs: " << (mismatches == 0 ? "all match" : "MISMATCH") << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
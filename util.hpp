@@ -1,10 +1,9 @@
 #pragma once
-#include <random>
+#include "random.hpp"
 
-// Global random number generator.
-std::mt19937& get_generator()
+// The calling thread's random number generator, see rng::Stream.
+rng::Stream& get_generator()
 {
-    static std::random_device rd;
-    static thread_local std::mt19937 generator = std::mt19937(rd());
+    static thread_local rng::Stream generator = rng::Stream(rng::random_seed(), rng::Phase::initialization, 0, 0, 0);
     return generator;
-}
\ No newline at end of file
+}